@@ -14,12 +14,100 @@
 
 typedef unsigned char byte;
 
-enum LoadResult: unsigned char {
-    SUCCESS,
-    NOT_PGM,
-    READING_ERROR
+class ImageExpr;
+
+/**
+  @brief Resultado de comparar dos imágenes con Image::Compare().
+**/
+struct ImageDiff{
+    bool same_size;             ///< true si ambas imágenes tienen las mismas dimensiones. Si no, el resto de campos no se calcula
+    long mismatches;            ///< Número de píxeles distintos
+    int max_diff;               ///< Máxima diferencia absoluta entre píxeles
+    unsigned long long sse;     ///< Suma de los cuadrados de las diferencias
+    double psnr;                ///< Relación señal/ruido de pico en dB (infinito si son iguales)
+    int first_row;              ///< Fila del primer píxel distinto, recorriendo por filas (-1 si no hay)
+    int first_col;              ///< Columna del primer píxel distinto (-1 si no hay)
+
+    /**
+      * @brief Indica si las imágenes son idénticas.
+      * @return true si tienen las mismas dimensiones y todos los píxeles iguales.
+      */
+    bool equal() const { return same_size && mismatches == 0; }
 };
 
+/**
+  @brief Transformación afín del plano de la imagen, en coordenadas (fila, columna).
+
+  Lleva el punto (r, c) de la imagen original al punto (r', c') de la imagen
+  transformada:
+
+      r' = m[0]*r + m[1]*c + m[2]
+      c' = m[3]*r + m[4]*c + m[5]
+
+  Las transformaciones se componen con Then():
+  \code
+  AffineTransform t = AffineTransform::Shear(0.02, 0).Then(AffineTransform::Rotation(1.5, 100, 100));
+  \endcode
+**/
+struct AffineTransform{
+    double m[6];                ///< Coeficientes de la transformación
+
+    /**
+      * @brief Transformación identidad.
+      */
+    static AffineTransform Identity();
+
+    /**
+      * @brief Desplazamiento.
+      * @param rows Filas que se desplaza cada punto.
+      * @param cols Columnas que se desplaza cada punto.
+      */
+    static AffineTransform Translation(double rows, double cols);
+
+    /**
+      * @brief Escalado respecto del origen (0, 0).
+      * @param row_factor Factor de escala vertical.
+      * @param col_factor Factor de escala horizontal.
+      */
+    static AffineTransform Scale(double row_factor, double col_factor);
+
+    /**
+      * @brief Giro alrededor de un punto.
+      * @param degrees Ángulo en grados, en sentido antihorario tal y como se ve la imagen.
+      * @param center_row Fila del centro de giro.
+      * @param center_col Columna del centro de giro.
+      */
+    static AffineTransform Rotation(double degrees, double center_row, double center_col);
+
+    /**
+      * @brief Cizalla respecto del origen (0, 0).
+      * @param row_per_col Filas que se desplaza cada punto por cada columna: r' = r + row_per_col*c.
+      * @param col_per_row Columnas que se desplaza cada punto por cada fila: c' = c + col_per_row*r.
+      */
+    static AffineTransform Shear(double row_per_col, double col_per_row);
+
+    /**
+      * @brief Composición de transformaciones.
+      * @param next Transformación que se aplica después de ésta.
+      * @return La transformación que aplica primero ésta y luego @p next.
+      */
+    AffineTransform Then(const AffineTransform & next) const;
+
+    /**
+      * @brief Transformación inversa.
+      * @param inverse Parámetro de salida con la inversa.
+      * @return false si la transformación no es invertible (y @p inverse no se modifica).
+      */
+    bool Inverse(AffineTransform & inverse) const;
+};
+
+/**
+  @brief Muestreo de Image::Warp().
+**/
+enum WarpSampling {
+    WARP_NEAREST,               ///< Píxel más cercano
+    WARP_BILINEAR               ///< Interpolación bilineal de los cuatro píxeles vecinos
+};
 
 /**
   @brief T.D.A. Imagen
@@ -32,6 +120,15 @@ enum LoadResult: unsigned char {
 
   \#include <Imagen.h>
 
+  <b>Concurrencia.</b> Los métodos const no modifican la imagen ni ningún estado
+  compartido oculto, y no reservan memoria salvo la de la imagen que devuelven
+  (Subsample(), Crop(), Zoom2X()...) o un búfer temporal local. Por tanto, varios
+  hilos pueden llamar a la vez a métodos const sobre la misma imagen. Los métodos
+  no const (Load(), set_pixel(), ShuffleRows(), AdjustContrast(), la asignación...)
+  necesitan acceso exclusivo: ningún otro hilo puede usar la imagen mientras se
+  ejecutan. Para que un hilo prepare la siguiente imagen mientras otros leen la
+  actual, véase ImageSwap.
+
   @author Andrés Gutiérrez
   @author Pablo García
   @date Octubre 2022
@@ -88,11 +185,12 @@ private :
     void Initialize (int nrows= 0, int ncols= 0, byte *buffer= 0);
 
     /**
-      @brief Lee una imagen PGM desde un archivo.
+      @brief Lee una imagen PGM o PGB desde un archivo.
       @param file_path Ruta del archivo a leer
       @return LoadResult
+      @post Si no tiene éxito la imagen queda vacía.
     **/
-    LoadResult LoadFromPGM(const char * file_path);
+    LoadResult LoadFromFile(const char * file_path);
 
     /**
       @brief Copy una imagen .
@@ -102,6 +200,21 @@ private :
     **/
     void Copy(const Image &orig);
 
+    /**
+      @brief Copia los píxeles de otra imagen con las mismas dimensiones.
+      @param orig Referencia a la imagen original cuyos píxeles vamos a copiar
+      @pre get_rows() == orig.get_rows() y get_cols() == orig.get_cols()
+      @post Reutiliza la memoria ya reservada. Si ambas imágenes tienen sus filas
+      consecutivas en memoria se copia con un único memcpy, y si no, fila a fila.
+    **/
+    void CopyPixels(const Image &orig);
+
+    /**
+      @brief Indica si las filas de la imagen están consecutivas en memoria.
+      @return true si img[i] == img[0] + i*cols para toda fila i.
+    **/
+    bool Contiguous() const;
+
     /**
       @brief Reserva o copia en memoria una imagen.
       @param nrows Número de filas que tendrá la imagen.
@@ -120,6 +233,61 @@ private :
       */
     void Destroy();
 
+    /**
+      * @brief Kernel de Subsample para un factor conocido en compilación.
+      * @param icon Imagen destino, de get_rows()/factor filas y get_cols()/factor columnas.
+      * @param first_row Primera fila de @p icon que se calcula. Por defecto, 0.
+      * @param last_row Fila de @p icon siguiente a la última que se calcula. Si es
+      * negativa, hasta la última fila de @p icon.
+      * @post Cada píxel calculado de @p icon es la media redondeada de su bloque
+      * factor x factor, con el mismo resultado que Mean() pero con aritmética entera.
+      */
+    template <int factor>
+    void SubsampleInto(Image & icon, int first_row = 0, int last_row = -1) const;
+
+    /**
+      * @brief Kernel de Zoom2X.
+      * @param zoomed Imagen destino, de 2*get_rows()-1 filas y 2*get_cols()-1 columnas.
+      * @pre La imagen no está vacía.
+      * @post Rellena @p zoomed con el mismo resultado que las medias de Mean() usadas por Zoom2X.
+      */
+    void Zoom2XInto(Image & zoomed) const;
+
+    /**
+      * @brief Kernel de Warp para una banda de filas.
+      * @param out Imagen destino.
+      * @param inverse Transformación de las coordenadas de @p out a las de esta imagen.
+      * @param sampling Muestreo.
+      * @param background Valor de los píxeles que caen fuera de esta imagen.
+      * @param first_row Primera fila de @p out que se calcula.
+      * @param last_row Fila de @p out siguiente a la última que se calcula.
+      * @pre La imagen no está vacía.
+      */
+    void WarpInto(Image & out, const AffineTransform & inverse, WarpSampling sampling, byte background,
+                  int first_row, int last_row) const;
+
+    /**
+      * @brief Tabla de AdjustContrast: valor de salida para cada valor de entrada.
+      * @param in1 Umbral inferior de la imagen de entrada.
+      * @param in2 Umbral superior de la imagen de entrada.
+      * @param out1 Umbral inferior de la imagen de salida.
+      * @param out2 Umbral superior de la imagen de salida.
+      * @param table Parámetro de salida con los 256 valores transformados.
+      * @pre in1 < in2 y out1 < out2.
+      */
+    static void ContrastTable(byte in1, byte in2, byte out1, byte out2, byte table[256]);
+
+    /**
+      * @brief Sustituye cada píxel por su valor en una tabla.
+      * @param table Tabla de 256 valores.
+      * @post El píxel de valor v pasa a valer table[v].
+      */
+    void ApplyTable(const byte table[256]);
+
+    friend class ImageExpr;
+    friend class ImagePyramid;
+    friend class ImageLabels;
+
 public :
 
     /**
@@ -147,6 +315,13 @@ public :
       */
     Image (const Image & orig);
 
+    /**
+      * @brief Constructor de movimiento.
+      * @param orig Imagen cuya memoria pasa a la nueva imagen.
+      * @post @p orig queda vacía. No se reserva ni se copia memoria.
+      */
+    Image (Image && orig) noexcept;
+
     /**
       * @brief Oper ador de tipo destructor.
       * @return void
@@ -159,9 +334,18 @@ public :
       * @param orig Referencia a la imagen original que desea copiarse.
       * @return Una referencia al objeto imagen modificado.
       * @post Destroy cualquier información que contuviera previamente la imagen que llama al operador de asignación.
+      * Si ambas imágenes tienen las mismas dimensiones se reutiliza la memoria ya reservada (no hay reservas).
       */
     Image & operator= (const Image & orig);
 
+    /**
+      * @brief Operador de asignación por movimiento.
+      * @param orig Imagen cuya memoria pasa a esta imagen.
+      * @return Una referencia al objeto imagen modificado.
+      * @post Se libera la memoria previa de esta imagen y @p orig queda vacía.
+      */
+    Image & operator= (Image && orig) noexcept;
+
     /**
       * @brief Funcion para conocer si una imagen está vacía.
       * @return Si la imagene está vacía
@@ -240,15 +424,59 @@ void set_pixel (int i, int j, byte value);
       */
     bool Save (const char * file_path) const;
 
+    /**
+      * @brief Almacena la imagen en disco en el formato comprimido PGB.
+      * @param file_path Ruta donde se almacenará la imagen.
+      * @return Devuelve true si la imagen se almacenó con éxito y false en caso contrario.
+      * @post La imagen no se modifica. Load() reconoce el formato al leerla.
+      * @see WritePGBImage
+      */
+    bool SaveCompressed (const char * file_path) const;
+
     /**
       * @brief Carga en memoria una imagen de disco .
       * @param file_path Ruta donde se encuentra el archivo desde el que cargar la imagen.
-      * @pre @p file_path debe ser una ruta válida que contenga un fichero . pgm
+      * @pre @p file_path debe ser una ruta válida que contenga un fichero .pgm o .pgb
       * @return Devuelve @b true si la imagen se carga con éxito y @b false en caso contrario.
       * @post La imagen previamente almacenada en el objeto que llama a la función se destruye.
       */
     bool Load (const char * file_path);
 
+    /**
+      * @brief Carga en memoria una imagen de disco e informa del motivo de fallo.
+      * @param file_path Ruta donde se encuentra el archivo desde el que cargar la imagen.
+      * @return SUCCESS si la imagen se carga con éxito y, en caso contrario, el motivo
+      * del fallo (ver LoadResult y LoadResultMessage()).
+      * @post La imagen previamente almacenada se destruye. Si no tiene éxito, queda vacía.
+      */
+    LoadResult LoadWithStatus (const char * file_path);
+
+    /**
+      * @brief Carga en memoria sólo una región de una imagen de disco.
+      *
+      * Equivale a cargar la imagen y llamar a Crop(), pero sólo lee del archivo
+      * los píxeles de la región (ver LoadImageRegion()).
+      *
+      * @param file_path Ruta del archivo PGM o PGB.
+      * @param nrow Fila inicial.
+      * @param ncol Columna inicial.
+      * @param height Número de filas que tomamos.
+      * @param width Número de columnas que tomamos.
+      * @param file_rows Parámetro de salida con las filas de la imagen del archivo.
+      * @param file_cols Parámetro de salida con las columnas de la imagen del archivo.
+      * @return SUCCESS si la región se carga con éxito, BAD_REGION si no cabe en
+      * la imagen del archivo, o el motivo del fallo.
+      * @post La imagen previamente almacenada se destruye. Si no tiene éxito, queda vacía.
+      */
+    LoadResult LoadRegion (const char * file_path, int nrow, int ncol, int height, int width,
+                           int & file_rows, int & file_cols);
+
+    /**
+      * @brief Carga en memoria sólo una región de una imagen de disco.
+      * @see LoadRegion(const char *, int, int, int, int, int &, int &)
+      */
+    LoadResult LoadRegion (const char * file_path, int nrow, int ncol, int height, int width);
+
     // Invierte
     void Invert();
 
@@ -312,12 +540,67 @@ void set_pixel (int i, int j, byte value);
       */
     Image Zoom2X() const;
 
+    /**
+      * @brief Aplica una transformación afín a la imagen (giros, cizallas, escalados...).
+      *
+      * Cada píxel (i, j) del resultado toma el valor del punto de la imagen original
+      * que @p transform lleva a (i, j). Las coordenadas se recorren en coma fija
+      * (16 bits de fracción) con incrementos constantes por fila, y el peso de cada
+      * vecino en la interpolación bilineal tiene 7 bits. La media de dos o cuatro
+      * píxeles se redondea como en Mean(), así que con un escalado por 2 el
+      * resultado coincide con Zoom2X().
+      *
+      * @param transform Transformación de la imagen original a la resultado.
+      * @param sampling Muestreo. Por defecto, bilineal.
+      * @param background Valor de los píxeles que caen fuera de la imagen original. Por defecto, 0.
+      * @param threads Hilos entre los que se reparten bandas de filas. Por defecto, 1.
+      * @pre @p transform es invertible y threads >= 1.
+      * @return Imagen con las mismas dimensiones que la original.
+      * @post La imagen no se modifica.
+      */
+    Image Warp(const AffineTransform & transform, WarpSampling sampling = WARP_BILINEAR,
+               byte background = 0, int threads = 1) const;
+
+    /**
+      * @brief Como Warp(transform, sampling, background, threads), pero con otras dimensiones de salida.
+      * @param transform Transformación de la imagen original a la resultado.
+      * @param out_rows Filas de la imagen resultado.
+      * @param out_cols Columnas de la imagen resultado.
+      * @param sampling Muestreo. Por defecto, bilineal.
+      * @param background Valor de los píxeles que caen fuera de la imagen original. Por defecto, 0.
+      * @param threads Hilos entre los que se reparten bandas de filas. Por defecto, 1.
+      * @pre @p transform es invertible, out_rows >= 0, out_cols >= 0 y threads >= 1.
+      * @return Imagen de @p out_rows filas y @p out_cols columnas.
+      * @post La imagen no se modifica.
+      */
+    Image Warp(const AffineTransform & transform, int out_rows, int out_cols,
+               WarpSampling sampling = WARP_BILINEAR, byte background = 0, int threads = 1) const;
+
     // Baraja pseudoaleatoriamente las filas de una imagen.
     /**
       * @brief Baraja pseudoaleatoriamente las filas de una imagen. Utiliza el concepto de anillo cíclico.
       * @post La imagen se modifica.
       */
     void ShuffleRows();
+
+    /**
+      * @brief Compara la imagen con otra píxel a píxel.
+      *
+      * Calcula todas las medidas de ImageDiff en una sola pasada por ambas imágenes.
+      *
+      * @param other Imagen con la que se compara.
+      * @return Diferencias entre ambas imágenes.
+      * @post Las imágenes no se modifican.
+      */
+    ImageDiff Compare(const Image & other) const;
+
+    /**
+      * @brief Comienza una expresión diferida sobre la imagen.
+      * @return Expresión vacía (identidad) sobre esta imagen. Ver ImageExpr en imageexpr.h.
+      * @pre La imagen debe seguir existiendo, sin modificarse, hasta que se evalúe la expresión.
+      * @post La imagen no se modifica.
+      */
+    ImageExpr lazy() const;
 } ;
 
 
@@ -2,13 +2,22 @@
   * @file imageIO.h
   * @brief Fichero cabecera para la E/S de imágenes
   *
-  * Permite la E/S de archivos de tipo PGM,PPM
+  * Permite la E/S de archivos de tipo PGM,PPM y del contenedor comprimido PGB
+  *
+  * Formato PGB: cabecera de 20 bytes ("PGB1" y, como enteros de 32 bits
+  * little-endian, filas, columnas, filas por bloque y número de bloques), un
+  * índice con una entrada de 13 bytes por bloque (desplazamiento en el archivo,
+  * 64 bits; tamaño comprimido, 32 bits; método, 8 bits) y los bloques. Cada
+  * bloque es una banda de filas completas comprimida de forma independiente,
+  * por lo que puede descomprimirse en paralelo o por separado.
   *
   */
 
 #ifndef _IMAGEN_ES_H_
 #define _IMAGEN_ES_H_
 
+#include <cstddef>
+
 /**
   * @brief Tipo de imagen
   *
@@ -17,7 +26,40 @@
   *
   * @see ReadImageKind
   */
-enum ImageKind {IMG_UNKNOWN, IMG_PGM, IMG_PPM};
+enum ImageKind {IMG_UNKNOWN, IMG_PGM, IMG_PPM, IMG_PGB};
+
+/**
+  * @brief Resultado de la lectura de una imagen
+  *
+  * @see LoadPGMImage
+  * @see LoadResultMessage
+  */
+enum LoadResult: unsigned char {
+    SUCCESS,        ///< La imagen se ha leído correctamente
+    NOT_PGM,        ///< El archivo no es una imagen PGM binaria (P5)
+    READING_ERROR,  ///< Error de E/S al leer el archivo
+    OPEN_ERROR,     ///< No se pudo abrir el archivo
+    BAD_HEADER,     ///< Cabecera PGM mal formada (dimensiones o valor máximo no válidos)
+    OVERSIZED,      ///< Dimensiones mayores que las admitidas (PGM_MAX_DIM)
+    TRUNCATED,      ///< El archivo tiene menos datos que los indicados en la cabecera
+    CORRUPT,        ///< Un bloque comprimido de un archivo PGB no es válido
+    BAD_REGION      ///< La región pedida no está dentro de la imagen
+};
+
+/**
+  * @brief Dimensión máxima (filas o columnas) admitida al leer una imagen PGM
+  */
+const int PGM_MAX_DIM = 5000;
+
+/**
+  * @brief Bytes del principio de un archivo PGM en los que tiene que estar su cabecera
+  */
+const int PGM_HEADER_CHUNK = 4096;
+
+/**
+  * @brief Tamaño aproximado en bytes de la banda de filas de cada bloque PGB
+  */
+const int PGB_BLOCK_BYTES = 65536;
 
 /**
   * @brief Devuelve el tipo de imagen del archivo
@@ -44,6 +86,137 @@ ImageKind ReadImageKind (const char *path);
   */
 unsigned char *ReadPGMImage (const char *path, int& rows, int& cols);
 
+/**
+  * @brief Lee una imagen de tipo PGM abriendo el archivo una sola vez
+  *
+  * Detecta el tipo, interpreta la cabecera y lee los píxeles con una única
+  * apertura del archivo: la cabecera se analiza sobre el primer bloque leído y
+  * los píxeles se leen directamente sobre el buffer de salida, ya reservado.
+  *
+  * @param path archivo a leer
+  * @param data Parámetro de salida con el puntero a los @a rows x @a cols bytes
+  * de la imagen, o 0 si no se ha podido leer.
+  * @param rows Parámetro de salida con las filas de la imagen.
+  * @param cols Parámetro de salida con las columnas de la imagen.
+  * @return SUCCESS o el motivo del fallo.
+  * @post En caso de éxito, @a data apunta a una zona de memoria reservada en
+  * memoria dinámica. Será el usuario el responsable de liberarla.
+  */
+LoadResult LoadPGMImage (const char *path, unsigned char *&data, int& rows, int& cols);
+
+/**
+  * @brief Lee una imagen PGB (PGM comprimido por bloques)
+  *
+  * Los bloques se descomprimen en paralelo si la imagen es grande.
+  *
+  * @param path archivo a leer
+  * @param data Parámetro de salida con el puntero a los @a rows x @a cols bytes
+  * de la imagen, o 0 si no se ha podido leer.
+  * @param rows Parámetro de salida con las filas de la imagen.
+  * @param cols Parámetro de salida con las columnas de la imagen.
+  * @return SUCCESS o el motivo del fallo.
+  * @post En caso de éxito, @a data apunta a una zona de memoria reservada en
+  * memoria dinámica. Será el usuario el responsable de liberarla.
+  */
+LoadResult LoadPGBImage (const char *path, unsigned char *&data, int& rows, int& cols);
+
+/**
+  * @brief Lee una banda de filas de una imagen PGB
+  *
+  * Sólo se leen y descomprimen los bloques que contienen las filas pedidas.
+  *
+  * @param path archivo a leer
+  * @param first primera fila a leer
+  * @param count número de filas a leer. Se recorta al final de la imagen.
+  * @param data Parámetro de salida con el puntero a las filas leídas, de
+  * @a cols bytes cada una, o 0 si no se ha podido leer o no hay filas que leer.
+  * @param rows Parámetro de salida con las filas de la imagen completa.
+  * @param cols Parámetro de salida con las columnas de la imagen.
+  * @return SUCCESS o el motivo del fallo.
+  * @pre first >= 0 y count >= 0
+  * @post En caso de éxito, @a data contiene max(0, min(count, rows-first)) filas.
+  */
+LoadResult LoadPGBRows (const char *path, int first, int count,
+                        unsigned char *&data, int& rows, int& cols);
+
+/**
+  * @brief Lee una imagen PGM o PGB, detectando el formato por su contenido
+  *
+  * @param path archivo a leer
+  * @param data Parámetro de salida con el puntero a los @a rows x @a cols bytes
+  * de la imagen, o 0 si no se ha podido leer.
+  * @param rows Parámetro de salida con las filas de la imagen.
+  * @param cols Parámetro de salida con las columnas de la imagen.
+  * @return SUCCESS o el motivo del fallo.
+  * @see LoadPGMImage
+  * @see LoadPGBImage
+  */
+LoadResult LoadImageFile (const char *path, unsigned char *&data, int& rows, int& cols);
+
+/**
+  * @brief Lee sólo una región rectangular de una imagen PGM o PGB
+  *
+  * En PGM las filas ocupan un tamaño fijo, así que la región se lee con lecturas
+  * posicionadas: una por fila, o una sola para todas si los huecos entre filas
+  * son pequeños. En PGB sólo se descomprimen los bloques con filas de la región.
+  * Los datos del archivo fuera de la región no se leen ni se comprueban.
+  *
+  * @param path archivo a leer
+  * @param row fila de la esquina superior izquierda de la región
+  * @param col columna de la esquina superior izquierda de la región
+  * @param height filas de la región
+  * @param width columnas de la región
+  * @param data Parámetro de salida con el puntero a los @a height x @a width
+  * bytes de la región, o 0 si no se ha podido leer o la región está vacía.
+  * @param rows Parámetro de salida con las filas de la imagen completa.
+  * @param cols Parámetro de salida con las columnas de la imagen completa.
+  * @return SUCCESS, BAD_REGION si la región no cabe en la imagen, o el motivo del fallo.
+  * @post En caso de éxito, @a data apunta a una zona de memoria reservada en
+  * memoria dinámica. Será el usuario el responsable de liberarla.
+  */
+LoadResult LoadImageRegion (const char *path, int row, int col, int height, int width,
+                            unsigned char *&data, int& rows, int& cols);
+
+/**
+  * @brief Interpreta la cabecera de una imagen PGM leída en memoria
+  *
+  * Permite conocer el tamaño de la imagen antes de leer sus píxeles.
+  *
+  * @param buf primeros bytes del archivo
+  * @param n número de bytes de @a buf: el tamaño del archivo o PGM_HEADER_CHUNK
+  * si es mayor
+  * @param rows Parámetro de salida con las filas de la imagen.
+  * @param cols Parámetro de salida con las columnas de la imagen.
+  * @param offset Parámetro de salida con la posición del primer píxel.
+  * @return SUCCESS o el motivo del fallo.
+  */
+LoadResult ParsePGMHeader (const unsigned char *buf, size_t n,
+                           int& rows, int& cols, size_t& offset);
+
+/**
+  * @brief Interpreta una imagen PGM completa leída en memoria
+  *
+  * Aplica las mismas comprobaciones que LoadPGMImage sobre el contenido completo
+  * de un archivo y deja los píxeles al principio del buffer.
+  *
+  * @param buf contenido del archivo. Se modifica.
+  * @param n número de bytes de @a buf
+  * @param rows Parámetro de salida con las filas de la imagen.
+  * @param cols Parámetro de salida con las columnas de la imagen.
+  * @return SUCCESS o el motivo del fallo.
+  * @post En caso de éxito, los @a rows x @a cols primeros bytes de @a buf son los
+  * píxeles de la imagen.
+  */
+LoadResult ParsePGMBuffer (unsigned char *buf, size_t n, int& rows, int& cols);
+
+/**
+  * @brief Descripción de un resultado de lectura
+  *
+  * @param result resultado a describir
+  * @return cadena estática con la descripción
+  */
+const char *LoadResultMessage (LoadResult result);
+
 /**
   * @brief Escribe una imagen de tipo PGM
   *
@@ -57,6 +230,25 @@ unsigned char *ReadPGMImage (const char *path, int& rows, int& cols);
 bool WritePGMImage (const char *path, const unsigned char *datos,
                     const int rows, const int cols);
 
+/**
+  * @brief Escribe una imagen comprimida en formato PGB
+  *
+  * Cada banda de filas se guarda con el método que menos ocupe: LZ (adecuado
+  * para imágenes sintéticas con zonas repetidas), LZ tras restar a cada píxel su
+  * vecino izquierdo, Huffman del error del predictor MED de LOCO-I (adecuado
+  * para fotografías y escaneos) o sin comprimir.
+  *
+  * @param path archivo a escribir
+  * @param datos punteros a los @a rows x @a cols bytes de la imagen
+  * @param rows filas de la imagen
+  * @param cols columnas de la imagen
+  * @param band_rows filas por bloque. Si es 0, las necesarias para unos
+  * PGB_BLOCK_BYTES bytes por bloque.
+  * @return si ha tenido éxito en la escritura.
+  */
+bool WritePGBImage (const char *path, const unsigned char *datos,
+                    const int rows, const int cols, int band_rows = 0);
+
 
 
 
@@ -0,0 +1,212 @@
+/**
+  * @file imageasync.h
+  * @brief Fichero cabecera para la E/S asíncrona de imágenes PGM
+  *
+  * Equivalentes asíncronos de ReadPGMImage y WritePGMImage que envían por lotes
+  * las lecturas y escrituras de muchos archivos a la vez. En Linux con io_uring
+  * las operaciones se envían al núcleo en un único io_uring_enter por lote; en
+  * núcleos sin io_uring se usa un conjunto de hilos que leen y escriben de
+  * forma síncrona.
+  *
+  */
+
+#ifndef _IMAGE_ASYNC_H_
+#define _IMAGE_ASYNC_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "imageIO.h"
+
+/**
+  * @brief Resultado de una lectura asíncrona
+  */
+struct PGMReadResult{
+    std::string path;       ///< Archivo leído
+    LoadResult result;      ///< SUCCESS o el motivo del fallo
+    unsigned char *data;    ///< rows x cols bytes de la imagen (0 si falla). Lo libera el usuario con delete[]
+    int rows;               ///< Filas de la imagen
+    int cols;               ///< Columnas de la imagen
+};
+
+/**
+  @brief E/S asíncrona de imágenes PGM.
+
+  Cada lectura o escritura se completa llamando a una función de retorno o
+  mediante un std::future. Las funciones de retorno se ejecutan en un hilo
+  interno, por lo que deben ser breves y no deben esperar a otras operaciones
+  del mismo AsyncPGMIO.
+
+  \code
+  AsyncPGMIO io;
+  std::vector<PGMReadResult> images = io.ReadPGMImages(paths);
+  std::future<bool> saved = io.WritePGMImageAsync("salida.pgm", images[0].data, images[0].rows, images[0].cols);
+  saved.get();
+  \endcode
+
+  @author Andrés Gutiérrez
+  @author Pablo García
+**/
+class AsyncPGMIO{
+public:
+
+    /**
+      * @brief Implementación de la E/S.
+      */
+    enum Backend {
+        AUTO,           ///< io_uring si el núcleo lo permite; si no, THREAD_POOL
+        IO_URING,       ///< io_uring (Linux 5.1 o posterior)
+        THREAD_POOL     ///< Hilos con lecturas y escrituras síncronas
+    };
+
+    typedef std::function<void(PGMReadResult &)> ReadCallback;  ///< Retorno de una lectura
+    typedef std::function<void(bool)> WriteCallback;            ///< Retorno de una escritura
+
+private:
+
+    struct Request;                                 ///< Operación en curso (ver imageasync.cpp)
+    struct Ring;                                    ///< Estado de io_uring (ver imageasync.cpp)
+
+    Backend kind;                                   ///< Implementación en uso
+    Ring * ring;                                    ///< Anillo de io_uring, o 0 con THREAD_POOL
+    std::thread reaper;                             ///< Hilo que recoge las compleciones de io_uring
+
+    std::vector<std::thread> workers;               ///< Hilos de THREAD_POOL
+    std::deque<std::function<void()> > tasks;       ///< Tareas pendientes de THREAD_POOL
+
+    std::mutex lock;                                ///< Protege tasks, pending y stopping
+    std::condition_variable task_ready;             ///< Avisa a los hilos de THREAD_POOL
+    std::condition_variable idle;                   ///< Avisa de que pending ha llegado a 0
+    size_t pending;                                 ///< Operaciones sin completar
+    bool stopping;                                  ///< true al destruirse
+
+    /**
+      @brief Intenta crear el anillo de io_uring.
+      @param entries Número de entradas del anillo.
+      @return false si el núcleo no ofrece io_uring.
+    **/
+    bool SetupRing(unsigned entries);
+
+    /**
+      @brief Bucle del hilo de compleciones de io_uring.
+    **/
+    void Reap();
+
+    /**
+      @brief Bucle de cada hilo de THREAD_POOL.
+    **/
+    void Work();
+
+    /**
+      @brief Encola una lectura.
+      @param path archivo a leer
+      @param done función de retorno
+      @param flush si es false, con io_uring la operación espera al siguiente envío del lote
+    **/
+    void Read(const char *path, ReadCallback done, bool flush);
+
+    /**
+      @brief Encola una escritura.
+      @param path archivo a escribir
+      @param data píxeles de la imagen
+      @param rows filas de la imagen
+      @param cols columnas de la imagen
+      @param done función de retorno
+      @param flush si es false, con io_uring la operación espera al siguiente envío del lote
+    **/
+    void Write(const char *path, const unsigned char *data, int rows, int cols, WriteCallback done, bool flush);
+
+    /**
+      @brief Envía a io_uring las operaciones encoladas.
+    **/
+    void Flush();
+
+    /**
+      @brief Marca una operación como terminada.
+    **/
+    void Finish();
+
+public:
+
+    /**
+      * @brief Constructor.
+      * @param backend Implementación a usar. Por defecto, AUTO.
+      * @param threads Hilos de THREAD_POOL. Por defecto, 4.
+      * @param queue_depth Operaciones simultáneas en io_uring. Por defecto, 64.
+      * @post Si se pide IO_URING y el núcleo no lo ofrece, se usa THREAD_POOL (ver backend()).
+      */
+    explicit AsyncPGMIO(Backend backend = AUTO, int threads = 4, unsigned queue_depth = 64);
+
+    /**
+      * @brief Destructor. Espera a que terminen todas las operaciones.
+      */
+    ~AsyncPGMIO();
+
+    AsyncPGMIO(const AsyncPGMIO &) = delete;
+    AsyncPGMIO & operator=(const AsyncPGMIO &) = delete;
+
+    /**
+      * @brief Implementación en uso.
+      * @return IO_URING o THREAD_POOL.
+      */
+    Backend backend() const { return kind; }
+
+    /**
+      * @brief Lee una imagen PGM de forma asíncrona.
+      * @param path archivo a leer
+      * @param done función a la que se llama con el resultado
+      */
+    void ReadPGMImageAsync(const char *path, ReadCallback done);
+
+    /**
+      * @brief Lee una imagen PGM de forma asíncrona.
+      * @param path archivo a leer
+      * @return futuro con el resultado de la lectura
+      */
+    std::future<PGMReadResult> ReadPGMImageAsync(const char *path);
+
+    /**
+      * @brief Escribe una imagen PGM de forma asíncrona.
+      * @param path archivo a escribir
+      * @param data @a rows x @a cols bytes de la imagen
+      * @param rows filas de la imagen
+      * @param cols columnas de la imagen
+      * @param done función a la que se llama con el éxito de la escritura
+      * @pre @p data debe seguir existiendo hasta que se llame a @p done
+      */
+    void WritePGMImageAsync(const char *path, const unsigned char *data, int rows, int cols, WriteCallback done);
+
+    /**
+      * @brief Escribe una imagen PGM de forma asíncrona.
+      * @param path archivo a escribir
+      * @param data @a rows x @a cols bytes de la imagen
+      * @param rows filas de la imagen
+      * @param cols columnas de la imagen
+      * @return futuro con el éxito de la escritura
+      * @pre @p data debe seguir existiendo hasta que el futuro esté listo
+      */
+    std::future<bool> WritePGMImageAsync(const char *path, const unsigned char *data, int rows, int cols);
+
+    /**
+      * @brief Lee un lote de imágenes PGM enviando todas las lecturas a la vez.
+      * @param paths archivos a leer
+      * @return un resultado por archivo, en el mismo orden que @p paths
+      */
+    std::vector<PGMReadResult> ReadPGMImages(const std::vector<std::string> & paths);
+
+    /**
+      * @brief Espera a que terminen todas las operaciones en curso.
+      */
+    void Wait();
+};
+
+#endif
+
+/* Fin Fichero: imageasync.h */
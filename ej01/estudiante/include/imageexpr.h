@@ -0,0 +1,152 @@
+/**
+ * @file imageexpr.h
+ * @brief Cabecera para la clase ImageExpr (expresiones diferidas sobre imágenes)
+ */
+
+#ifndef _IMAGE_EXPR_H_
+#define _IMAGE_EXPR_H_
+
+#include <vector>
+#include "image.h"
+
+/**
+  @brief Expresión diferida sobre una imagen.
+
+  Registra una secuencia de operaciones sobre una imagen sin ejecutarlas y las
+  evalúa todas juntas con eval():
+
+  \code
+  Image result = img.lazy().invert().contrast(50, 200, 10, 240).crop(0, 0, 100, 100).eval();
+  \endcode
+
+  El resultado es idéntico al de aplicar las operaciones una a una sobre la imagen
+  (Invert(), AdjustContrast(), Crop(), Subsample() y Zoom2X()), pero:
+
+  - Las operaciones puntuales (invert, contrast) se componen en una única tabla de
+    256 valores, que conserva el redondeo de cada paso.
+  - Los recortes (crop) se componen entre sí y conmutan con las operaciones
+    puntuales, de modo que sólo se leen los píxeles del recorte final.
+  - Una operación de región (subsample, zoom2x) se aplica por bandas de filas
+    sobre la salida de la tabla, sin materializar la imagen intermedia completa.
+
+  Cada subsample o zoom2x cierra una etapa; las operaciones que le siguen forman
+  una etapa nueva que se evalúa sobre su resultado.
+
+  @author Andrés Gutiérrez
+  @author Pablo García
+**/
+class ImageExpr{
+private:
+
+    /**
+      @brief Tipo de operación de región con la que termina una etapa.
+    **/
+    enum Resample {NONE, SUBSAMPLE, ZOOM};
+
+    /**
+      @brief Etapa de la expresión: recorte + tabla + operación de región.
+    **/
+    struct Stage{
+        int row, col;           ///< Esquina del recorte sobre la entrada de la etapa
+        int height, width;      ///< Dimensiones del recorte (-1: entrada completa)
+        byte table[256];        ///< Tabla compuesta de las operaciones puntuales
+        bool identity;          ///< true si la tabla es la identidad
+        Resample resample;      ///< Operación de región final
+        int factor;             ///< Factor de Subsample
+    };
+
+    /**
+      @brief Imagen sobre la que se evalúa la expresión.
+    **/
+    const Image * source;
+
+    /**
+      @brief Etapas registradas, en orden de evaluación.
+    **/
+    std::vector<Stage> stages;
+
+    /**
+      @brief Dimensiones del resultado de la expresión registrada hasta ahora.
+    **/
+    int out_rows, out_cols;
+
+    /**
+      @brief Etapa abierta a la que añadir operaciones puntuales o recortes.
+      @return La última etapa, o una nueva si la última ya termina en una operación de región.
+    **/
+    Stage & Open();
+
+    /**
+      @brief Compone una tabla con las operaciones puntuales de la etapa abierta.
+      @param table Tabla a aplicar después de las ya registradas.
+    **/
+    void Compose(const byte table[256]);
+
+    /**
+      @brief Evalúa una etapa.
+      @param stage Etapa a evaluar.
+      @param in Entrada de la etapa.
+      @return Salida de la etapa.
+    **/
+    static Image Evaluate(const Stage & stage, const Image & in);
+
+public:
+
+    /**
+      * @brief Constructor.
+      * @param img Imagen sobre la que se construye la expresión.
+      * @pre @p img debe existir, sin modificarse, hasta la llamada a eval().
+      */
+    explicit ImageExpr(const Image & img);
+
+    /**
+      * @brief Registra Invert().
+      * @return Referencia a la expresión.
+      */
+    ImageExpr & invert();
+
+    /**
+      * @brief Registra AdjustContrast(in1, in2, out1, out2).
+      * @param in1 Umbral inferior de la imagen de entrada.
+      * @param in2 Umbral superior de la imagen de entrada.
+      * @param out1 Umbral inferior de la imagen de salida.
+      * @param out2 Umbral superior de la imagen de salida.
+      * @pre in1 < in2 y out1 < out2.
+      * @return Referencia a la expresión.
+      */
+    ImageExpr & contrast(byte in1, byte in2, byte out1, byte out2);
+
+    /**
+      * @brief Registra Crop(nrow, ncol, height, width).
+      * @param nrow Fila inicial.
+      * @param ncol Columna inicial.
+      * @param height Número de filas que tomamos.
+      * @param width Número de columnas que tomamos.
+      * @pre El recorte está dentro de la imagen en este punto de la expresión.
+      * @return Referencia a la expresión.
+      */
+    ImageExpr & crop(int nrow, int ncol, int height, int width);
+
+    /**
+      * @brief Registra Subsample(factor).
+      * @param factor Factor de reducción.
+      * @pre factor > 0
+      * @return Referencia a la expresión.
+      */
+    ImageExpr & subsample(int factor);
+
+    /**
+      * @brief Registra Zoom2X().
+      * @return Referencia a la expresión.
+      */
+    ImageExpr & zoom2x();
+
+    /**
+      * @brief Evalúa la expresión.
+      * @return Imagen resultado.
+      * @post La imagen origen no se modifica.
+      */
+    Image eval() const;
+};
+
+#endif // _IMAGE_EXPR_H_
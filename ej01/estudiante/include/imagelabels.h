@@ -0,0 +1,112 @@
+/**
+ * @file imagelabels.h
+ * @brief Cabecera para la clase ImageLabels (etiquetado de componentes conexas)
+ */
+
+#ifndef _IMAGE_LABELS_H_
+#define _IMAGE_LABELS_H_
+
+#include <vector>
+
+#include "image.h"
+
+/**
+  @brief Estadísticas de una componente conexa.
+
+  El rectángulo que la contiene usa los mismos parámetros que Image::Crop(), así que
+  \c image.Crop(c.row, c.col, c.height, c.width) extrae la componente.
+**/
+struct ComponentStats{
+    long area;                  ///< Número de píxeles
+    int row;                    ///< Primera fila del rectángulo que la contiene
+    int col;                    ///< Primera columna del rectángulo que la contiene
+    int height;                 ///< Filas del rectángulo que la contiene
+    int width;                  ///< Columnas del rectángulo que la contiene
+    double mean;                ///< Valor medio de sus píxeles, redondeado como en Image::Mean()
+};
+
+/**
+  @brief Etiquetado de las componentes conexas de una imagen umbralizada.
+
+  Los píxeles de valor mayor o igual que el umbral son de primer plano; el resto
+  son fondo. Dos píxeles de primer plano están en la misma componente si se llega
+  de uno a otro por píxeles de primer plano vecinos (4 u 8 vecinos). Cada
+  componente recibe una etiqueta de 1 a count(), en el orden en que aparece su
+  primer píxel al recorrer la imagen por filas; el fondo tiene la etiqueta 0.
+
+  Se etiqueta en dos pasadas con unión-búsqueda. La imagen se reparte en bandas de
+  filas que se etiquetan en paralelo, se unen las componentes que cruzan el borde
+  entre bandas y una segunda pasada, también en paralelo, pone las etiquetas
+  definitivas y acumula las estadísticas. El resultado no depende del número de hilos.
+
+  \code
+  image.AdjustContrast(127, 128, 0, 255);         // umbral
+  ImageLabels labels(image, 128, 8);
+  for (int k = 1; k <= labels.count(); k++)
+      cout << labels.component(k).area << endl;
+  \endcode
+
+  @author Andrés Gutiérrez
+  @author Pablo García
+**/
+class ImageLabels{
+private:
+
+    int rows;                               ///< Filas de la imagen etiquetada
+    int cols;                               ///< Columnas de la imagen etiquetada
+    std::vector<int> labels;                ///< Etiqueta de cada píxel, por filas
+    std::vector<ComponentStats> stats;      ///< stats[k-1] son las estadísticas de la componente k
+
+public:
+
+    /**
+      * @brief Constructor por defecto. No hay componentes.
+      */
+    ImageLabels();
+
+    /**
+      * @brief Constructor. Etiqueta las componentes de una imagen (ver Label()).
+      * @param image Imagen a etiquetar.
+      * @param threshold Valor mínimo de los píxeles de primer plano. Por defecto, 128.
+      * @param connectivity Vecindad: 4 u 8. Por defecto, 8.
+      * @param threads Hilos entre los que se reparten bandas de filas. Por defecto, 1.
+      */
+    explicit ImageLabels(const Image & image, byte threshold = 128, int connectivity = 8, int threads = 1);
+
+    /**
+      * @brief Etiqueta las componentes conexas de una imagen.
+      * @param image Imagen a etiquetar.
+      * @param threshold Valor mínimo de los píxeles de primer plano. Por defecto, 128.
+      * @param connectivity Vecindad: 4 (arriba, abajo, izquierda y derecha) u 8
+      * (también las diagonales). Por defecto, 8.
+      * @param threads Hilos entre los que se reparten bandas de filas. Por defecto, 1.
+      * @pre connectivity es 4 u 8, y threads >= 1.
+      * @post Se descartan las etiquetas anteriores.
+      */
+    void Label(const Image & image, byte threshold = 128, int connectivity = 8, int threads = 1);
+
+    /**
+      * @brief Número de componentes.
+      * @return El número de componentes conexas.
+      */
+    int count() const { return stats.size(); }
+
+    /**
+      * @brief Etiqueta de un píxel.
+      * @param i Fila del píxel.
+      * @param j Columna del píxel.
+      * @pre 0 <= i < filas y 0 <= j < columnas de la imagen etiquetada.
+      * @return 0 si el píxel es fondo, y si no, la etiqueta de su componente.
+      */
+    int label(int i, int j) const { return labels[(size_t)i * cols + j]; }
+
+    /**
+      * @brief Estadísticas de una componente.
+      * @param k Etiqueta de la componente.
+      * @pre 1 <= k <= count()
+      * @return Área, rectángulo y valor medio de la componente.
+      */
+    const ComponentStats & component(int k) const;
+};
+
+#endif // _IMAGE_LABELS_H_
@@ -0,0 +1,115 @@
+/**
+ * @file imageloader.h
+ * @brief Cabecera para la clase ImageLoader (carga de imágenes en paralelo con precarga)
+ */
+
+#ifndef _IMAGE_LOADER_H_
+#define _IMAGE_LOADER_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "image.h"
+
+/**
+  @brief Imagen cargada por un ImageLoader.
+**/
+struct LoadedImage{
+    std::string path;   ///< Ruta del archivo
+    size_t index;       ///< Posición del archivo en la lista del ImageLoader
+    LoadResult result;  ///< Resultado de la lectura (ver LoadResultMessage())
+    Image image;        ///< Imagen leída (vacía si result != SUCCESS)
+};
+
+/**
+  @brief Cargador de listas de imágenes en paralelo.
+
+  Lee y decodifica una lista de archivos PGM en hilos de E/S propios y deja las
+  imágenes en una cola acotada, de forma que el consumidor procesa una imagen
+  mientras se leen las siguientes:
+
+  \code
+  ImageLoader loader(paths);
+  LoadedImage item;
+  while (loader.Next(item))
+      if (item.result == SUCCESS)
+          item.image.Invert();
+  \endcode
+
+  Las imágenes se entregan en el orden en que terminan de leerse (ver
+  LoadedImage::index). En memoria hay como mucho @a capacity imágenes en la cola
+  más una por cada hilo de E/S. Next() puede llamarse desde varios hilos
+  consumidores a la vez.
+
+  @author Andrés Gutiérrez
+  @author Pablo García
+**/
+class ImageLoader{
+private:
+
+    std::vector<std::string> paths;     ///< Archivos a leer
+    size_t capacity;                    ///< Máximo de imágenes en la cola
+
+    std::mutex lock;                    ///< Protege todos los campos siguientes
+    std::condition_variable not_full;   ///< Avisa a los hilos de E/S de que hay hueco en la cola
+    std::condition_variable not_empty;  ///< Avisa a los consumidores de que hay imágenes en la cola
+    std::deque<LoadedImage> ready;      ///< Imágenes leídas pendientes de entregar
+    size_t next_path;                   ///< Siguiente archivo a leer
+    size_t delivered;                   ///< Imágenes ya entregadas por Next()
+    bool stopping;                      ///< true si el cargador se está destruyendo
+
+    std::vector<std::thread> workers;   ///< Hilos de E/S
+
+    /**
+      @brief Bucle de cada hilo de E/S: lee archivos hasta agotar la lista.
+    **/
+    void Work();
+
+public:
+
+    /**
+      * @brief Constructor. Comienza a leer inmediatamente.
+      * @param files Archivos a leer.
+      * @param io_threads Número de hilos de E/S. Por defecto, 2.
+      * @param queue_capacity Máximo de imágenes leídas en espera de ser consumidas. Por defecto, 4.
+      * @pre io_threads > 0 y queue_capacity > 0
+      */
+    ImageLoader(const std::vector<std::string> & files, int io_threads = 2, size_t queue_capacity = 4);
+
+    /**
+      * @brief Destructor. Detiene y espera a los hilos de E/S.
+      * @post Las imágenes no consumidas se descartan.
+      */
+    ~ImageLoader();
+
+    ImageLoader(const ImageLoader &) = delete;
+    ImageLoader & operator=(const ImageLoader &) = delete;
+
+    /**
+      * @brief Obtiene la siguiente imagen leída, esperando si aún no hay ninguna.
+      * @param item Parámetro de salida con la imagen y su resultado de lectura.
+      * @return false si ya se han entregado todas las imágenes de la lista.
+      */
+    bool Next(LoadedImage & item);
+
+    /**
+      * @brief Número de archivos de la lista.
+      * @return El número de imágenes que entregará Next().
+      */
+    size_t size() const { return paths.size(); }
+};
+
+/**
+  * @brief Expande una lista de rutas a archivos PGM o PGB.
+  * @param args Rutas a archivos o directorios.
+  * @return Los archivos de @p args y, para cada directorio, sus archivos con
+  * extensión .pgm o .pgb en orden alfabético.
+  */
+std::vector<std::string> ExpandImagePaths(const std::vector<std::string> & args);
+
+#endif // _IMAGE_LOADER_H_
@@ -0,0 +1,87 @@
+/**
+  * @file imageperf.h
+  * @brief Fichero cabecera para la instrumentación de rendimiento de la clase Image
+  *
+  * Si se compila con la macro IMAGE_PERF_COUNTERS (opción de CMake del mismo
+  * nombre), cada operación de Image se envuelve con contadores hardware de
+  * perf_event_open (ciclos, instrucciones, fallos de la caché de último nivel y
+  * fallos de predicción de saltos). Si el sistema no ofrece esos contadores sólo
+  * se mide el tiempo. Sin la macro, IMAGE_PERF_SCOPE no genera código.
+  *
+  */
+
+#ifndef _IMAGE_PERF_H_
+#define _IMAGE_PERF_H_
+
+#include <ostream>
+
+/**
+  * @brief Mide la operación @p name desde este punto hasta el final del ámbito.
+  *
+  * Sólo se mide el ámbito más externo de cada hilo, de forma que las operaciones
+  * que llaman a otras (p.e. Zoom2X a Mean) no se cuentan dos veces.
+  */
+#ifdef IMAGE_PERF_COUNTERS
+#define IMAGE_PERF_SCOPE(name) PerfScope _image_perf_scope_(name)
+#else
+#define IMAGE_PERF_SCOPE(name) ((void)0)
+#endif
+
+/**
+  * @brief Medición RAII de una operación.
+  *
+  * Lee los contadores (o el reloj) al construirse y al destruirse, y acumula la
+  * diferencia en el informe de la operación.
+  */
+class PerfScope{
+private:
+    const char * name;              ///< Nombre de la operación medida
+    bool active;                    ///< false si es un ámbito anidado (no se mide)
+    long long start_ns;             ///< Instante de inicio
+    unsigned long long start[4];    ///< Contadores al inicio
+    bool counters;                  ///< true si se han leído los contadores hardware
+
+public:
+    /**
+      * @brief Comienza la medición de la operación @p op_name.
+      * @param op_name Nombre de la operación. Debe ser una cadena estática.
+      */
+    explicit PerfScope(const char * op_name);
+
+    /**
+      * @brief Termina la medición y la acumula en el informe.
+      */
+    ~PerfScope();
+
+    PerfScope(const PerfScope &) = delete;
+    PerfScope & operator=(const PerfScope &) = delete;
+};
+
+/**
+  * @brief Indica si la instrumentación está compilada.
+  * @return true si se compiló con IMAGE_PERF_COUNTERS.
+  */
+bool PerfEnabled();
+
+/**
+  * @brief Indica si hay contadores hardware disponibles en este sistema.
+  * @return false si perf_event_open no está disponible (sólo se mide el tiempo).
+  */
+bool PerfCountersAvailable();
+
+/**
+  * @brief Escribe el informe acumulado por operación.
+  * @param os Flujo de salida.
+  * @post Muestra llamadas, tiempo total y medio y, si hay contadores, ciclos,
+  * instrucciones por ciclo, fallos de LLC y fallos de predicción por llamada.
+  */
+void PerfReport(std::ostream & os);
+
+/**
+  * @brief Borra el informe acumulado.
+  */
+void PerfReset();
+
+#endif
+
+/* Fin Fichero: imageperf.h */
@@ -0,0 +1,128 @@
+/**
+ * @file imagepyramid.h
+ * @brief Cabecera para la clase ImagePyramid (pirámide de resoluciones de una imagen)
+ */
+
+#ifndef _IMAGE_PYRAMID_H_
+#define _IMAGE_PYRAMID_H_
+
+#include <vector>
+
+#include "image.h"
+
+/**
+  @brief Pirámide de resoluciones (mipmap) de una imagen.
+
+  El nivel 0 es la imagen original y cada nivel k > 0 es el Subsample(2) del
+  nivel k-1, de forma que el nivel k tiene get_rows()/2^k filas y
+  get_cols()/2^k columnas. Cada nivel se calcula a partir del anterior, así que
+  construir todos los niveles lee cada píxel original una sola vez. Como cada
+  nivel se redondea, el nivel k puede diferir en una unidad de Subsample(2^k).
+
+  \code
+  ImagePyramid pyramid(image);
+  int k = pyramid.LevelFor(1024, 1024, 256, 256);    // k = 2
+  const Image & view = pyramid.level(k);
+  pyramid.Save("imagen.pyr");
+  \endcode
+
+  @author Andrés Gutiérrez
+  @author Pablo García
+**/
+class ImagePyramid{
+private:
+
+    std::vector<Image> levels;  ///< levels[k] es el nivel k
+
+public:
+
+    /**
+      * @brief Constructor por defecto. Crea una pirámide sin niveles.
+      */
+    ImagePyramid();
+
+    /**
+      * @brief Constructor. Construye la pirámide de una imagen (ver Build()).
+      * @param base Imagen original.
+      * @param min_side Lado mínimo de los niveles. Por defecto, 1.
+      * @param threads Hilos con los que calcular cada nivel. Por defecto, 1.
+      */
+    explicit ImagePyramid(const Image & base, int min_side = 1, int threads = 1);
+
+    /**
+      * @brief Construye la pirámide de una imagen.
+      * @param base Imagen original.
+      * @param min_side Lado mínimo de los niveles: se añaden niveles mientras el
+      * siguiente tenga al menos @p min_side filas y columnas.
+      * @param threads Hilos con los que calcular cada nivel. Los niveles grandes
+      * se reparten en bandas de filas, una por hilo.
+      * @pre min_side >= 1 y threads >= 1
+      * @post Los niveles anteriores se descartan. Si @p base está vacía, la
+      * pirámide queda sin niveles.
+      */
+    void Build(const Image & base, int min_side = 1, int threads = 1);
+
+    /**
+      * @brief Número de niveles.
+      * @return El número de niveles, contando la imagen original.
+      */
+    int size() const { return levels.size(); }
+
+    /**
+      * @brief Consulta un nivel.
+      * @param k Nivel.
+      * @pre 0 <= k < size()
+      * @return El nivel @p k.
+      */
+    const Image & level(int k) const;
+
+    /**
+      * @brief Nivel adecuado para mostrar una región de la imagen en una vista.
+      *
+      * Devuelve el nivel más reducido que aún tiene al menos la resolución de la
+      * vista, es decir, el mayor k con 2^k <= min(region_rows/view_rows,
+      * region_cols/view_cols), limitado a los niveles existentes. Coste O(1).
+      *
+      * @param region_rows Filas de la región, en píxeles del nivel 0.
+      * @param region_cols Columnas de la región, en píxeles del nivel 0.
+      * @param view_rows Filas de la vista.
+      * @param view_cols Columnas de la vista.
+      * @pre size() > 0, view_rows > 0 y view_cols > 0
+      * @return El nivel.
+      */
+    int LevelFor(int region_rows, int region_cols, int view_rows, int view_cols) const;
+
+    /**
+      * @brief Guarda todos los niveles en un archivo.
+      *
+      * Formato: "PYR1", el número de niveles y una tabla con el desplazamiento,
+      * las filas y las columnas de cada nivel, seguidas de los píxeles de cada
+      * nivel sin comprimir. Los enteros son little-endian.
+      *
+      * @param file_path Ruta del archivo.
+      * @return true si se ha guardado con éxito.
+      */
+    bool Save(const char * file_path) const;
+
+    /**
+      * @brief Carga todos los niveles de un archivo guardado con Save().
+      * @param file_path Ruta del archivo.
+      * @return SUCCESS o el motivo del fallo.
+      * @post Si no tiene éxito, la pirámide queda sin niveles.
+      */
+    LoadResult Load(const char * file_path);
+
+    /**
+      * @brief Carga un solo nivel de un archivo guardado con Save().
+      *
+      * Sólo se leen la tabla de niveles y los píxeles del nivel pedido.
+      *
+      * @param file_path Ruta del archivo.
+      * @param k Nivel.
+      * @param image Parámetro de salida con el nivel.
+      * @return SUCCESS, BAD_REGION si el archivo no tiene el nivel @p k, o el motivo del fallo.
+      */
+    static LoadResult LoadLevel(const char * file_path, int k, Image & image);
+};
+
+#endif // _IMAGE_PYRAMID_H_
@@ -0,0 +1,143 @@
+/**
+ * @file imageswap.h
+ * @brief Cabecera para la clase ImageSwap (doble búfer de imágenes para lectores concurrentes)
+ */
+
+#ifndef _IMAGE_SWAP_H_
+#define _IMAGE_SWAP_H_
+
+#include <atomic>
+
+#include "image.h"
+
+/**
+  @brief Doble búfer de imágenes: un hilo escritor prepara la siguiente imagen
+  mientras varios hilos lectores usan la actual.
+
+  Hay dos imágenes: la publicada, que sólo se lee, y la trasera, que sólo modifica
+  el escritor. Publish() las intercambia con una operación atómica, sin bloquear
+  a los lectores. Cada lector fija la imagen publicada con Read() mientras la usa,
+  y el escritor no vuelve a modificar una imagen hasta que la sueltan todos los
+  lectores que la fijaron.
+
+  \code
+  ImageSwap frames(first);
+
+  // Hilos lectores
+  ImageSwap::Frame frame = frames.Read();
+  double mean = frame.image().Mean(0, 0, 10, 10);
+
+  // Hilo escritor
+  Image & next = frames.Back();      // espera a que no haya lectores
+  next.Load("siguiente.pgm");
+  frames.Publish();
+  \endcode
+
+  Read() y generation() pueden llamarse desde cualquier hilo a la vez. Back(),
+  TryBack() y Publish() sólo desde un hilo escritor cada vez.
+
+  @author Andrés Gutiérrez
+  @author Pablo García
+**/
+class ImageSwap{
+private:
+
+    Image buffers[2];                   ///< Imágenes publicada y trasera
+    unsigned long generations[2];       ///< Generación de cada imagen (la escribe sólo el escritor)
+    std::atomic<int> front;             ///< Índice de la imagen publicada
+    std::atomic<int> readers[2];        ///< Lectores que tienen fijada cada imagen
+    std::atomic<unsigned long> last;    ///< Generación de la última imagen publicada
+
+public:
+
+    /**
+      @brief Imagen fijada por un lector.
+
+      Mientras exista, el escritor no modifica la imagen. Se suelta al destruirse.
+      No debe sobrevivir al ImageSwap del que procede.
+    **/
+    class Frame{
+    private:
+        ImageSwap * owner;              ///< Doble búfer de origen (0 si ya se ha soltado)
+        int slot;                       ///< Índice de la imagen fijada
+
+        Frame(ImageSwap * swap, int k) : owner(swap), slot(k) {}
+        friend class ImageSwap;
+
+    public:
+        Frame(Frame && orig) noexcept;
+        ~Frame();
+
+        Frame(const Frame &) = delete;
+        Frame & operator=(const Frame &) = delete;
+        Frame & operator=(Frame &&) = delete;
+
+        /**
+          * @brief Imagen fijada.
+          * @return Referencia constante a la imagen, válida mientras exista el Frame.
+          */
+        const Image & image() const { return owner->buffers[slot]; }
+
+        /**
+          * @brief Generación de la imagen fijada.
+          * @return 0 para la imagen inicial y n para la n-ésima publicada.
+          */
+        unsigned long generation() const { return owner->generations[slot]; }
+    };
+
+    /**
+      * @brief Constructor. La imagen publicada inicial está vacía.
+      */
+    ImageSwap();
+
+    /**
+      * @brief Constructor.
+      * @param first Imagen publicada inicial, que se copia.
+      */
+    explicit ImageSwap(const Image & first);
+
+    ImageSwap(const ImageSwap &) = delete;
+    ImageSwap & operator=(const ImageSwap &) = delete;
+
+    /**
+      * @brief Fija la imagen publicada para leerla.
+      * @return La imagen fijada. No se reserva memoria ni se bloquea al escritor.
+      * @post La imagen fijada no cambia aunque el escritor publique otra.
+      */
+    Frame Read();
+
+    /**
+      * @brief Generación de la última imagen publicada, para comprobar sin fijarla
+      * si hay una imagen nueva.
+      * @return El número de imágenes publicadas con Publish().
+      */
+    unsigned long generation() const;
+
+    /**
+      * @brief Imagen trasera, para que el escritor prepare la siguiente.
+      *
+      * Contiene la imagen publicada hace dos llamadas a Publish() (o la vacía), así
+      * que asignarle una imagen de las mismas dimensiones reutiliza su memoria.
+      * Espera a que los lectores que aún la tengan fijada la suelten.
+      *
+      * @return Referencia a la imagen trasera.
+      * @pre Sólo la llama el hilo escritor.
+      */
+    Image & Back();
+
+    /**
+      * @brief Como Back(), pero sin esperar.
+      * @return La imagen trasera, o 0 si algún lector aún la tiene fijada.
+      * @pre Sólo la llama el hilo escritor.
+      */
+    Image * TryBack();
+
+    /**
+      * @brief Publica la imagen trasera, que pasa a ser la que obtiene Read().
+      * @pre Sólo la llama el hilo escritor, después de Back() o de un TryBack() con éxito.
+      * @post La imagen publicada hasta ahora pasa a ser la trasera.
+      */
+    void Publish();
+};
+
+#endif // _IMAGE_SWAP_H_
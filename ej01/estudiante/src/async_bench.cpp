@@ -0,0 +1,240 @@
+/**
+ * @file async_bench.cpp
+ * @brief Fichero que comprueba AsyncPGMIO con sus dos implementaciones y mide su rendimiento frente a la E/S síncrona.
+ *
+ * Con io_uring y con el conjunto de hilos, escribe un lote de imágenes de
+ * contenido conocido, las vuelve a leer por lotes y de una en una, y comprueba
+ * cada píxel y los errores de archivos que no existen, no son PGM o son demasiado
+ * grandes. Después mide cuántas imágenes por segundo se escriben y leen con cada
+ * implementación y con WritePGMImage y LoadPGMImage. Por último, lee el lote con un ImageLoader y
+ * varios hilos consumidores a la vez, comprobando que cada imagen se entrega una
+ * sola vez. Termina con código 1 si encuentra algún error.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <string>
+#include <vector>
+
+#include <imageasync.h>
+#include <imageloader.h>
+
+using namespace std;
+
+// Segundos desde t0
+static double Seconds(chrono::steady_clock::time_point t0){
+    return chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+}
+
+// Píxeles de la imagen k-ésima del lote
+static vector<unsigned char> MakePixels(int k, int rows, int cols){
+    vector<unsigned char> data((size_t)rows*cols);
+    for (int i = 0; i < rows; i++)
+        for (int j = 0; j < cols; j++)
+            data[(size_t)i*cols + j] = (unsigned char)(k*31 + i*7 + j*13 + (i ^ j));
+    return data;
+}
+
+// Comprueba una imagen leída frente a la que se escribió. Libera sus píxeles.
+static long CheckRead(PGMReadResult & out, const vector<unsigned char> & expected, int rows, int cols){
+    long errors = 0;
+    if (out.result != SUCCESS || out.rows != rows || out.cols != cols ||
+        !equal(expected.begin(), expected.end(), out.data))
+        errors++;
+    delete[] out.data;
+    out.data = 0;
+    return errors;
+}
+
+static const char * BackendName(AsyncPGMIO::Backend backend){
+    return backend == AsyncPGMIO::IO_URING ? "io_uring" : "hilos";
+}
+
+// Escribe y lee el lote con la implementación pedida y comprueba los resultados.
+// Devuelve el número de errores y deja en write_s y read_s el tiempo de cada fase.
+static long Check(AsyncPGMIO::Backend backend, const vector<string> & paths,
+                  const vector<vector<unsigned char> > & images, int rows, int cols,
+                  const string & tmp_dir, double & write_s, double & read_s){
+    AsyncPGMIO io(backend);
+    if (io.backend() != backend)
+        cout << "Aviso: " << BackendName(backend) << " no disponible, se usa " << BackendName(io.backend()) << endl;
+    long errors = 0;
+
+    // Escrituras por lotes con función de retorno
+    chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+    vector<char> written(paths.size(), 0);
+    for (size_t k = 0; k < paths.size(); k++)
+        io.WritePGMImageAsync(paths[k].c_str(), images[k].data(), rows, cols,
+                              [&written, k](bool ok){ written[k] = ok; });
+    io.Wait();
+    write_s = Seconds(t0);
+    for (size_t k = 0; k < paths.size(); k++)
+        if (!written[k])
+            errors++;
+
+    // Lectura de todo el lote a la vez
+    t0 = chrono::steady_clock::now();
+    vector<PGMReadResult> batch = io.ReadPGMImages(paths);
+    read_s = Seconds(t0);
+    for (size_t k = 0; k < paths.size(); k++)
+        errors += CheckRead(batch[k], images[k], rows, cols);
+
+    // Lecturas sueltas con futuro, y errores de archivos que no existen, no son PGM
+    // o superan PGM_MAX_DIM
+    string missing = tmp_dir + "/async_bench.tmp.missing.pgm";
+    string not_pgm = tmp_dir + "/async_bench.tmp.txt";
+    string oversized = tmp_dir + "/async_bench.tmp.oversized.pgm";
+    ofstream(not_pgm.c_str()) << "no es una imagen PGM" << endl;
+    ofstream(oversized.c_str()) << "P5\n" << PGM_MAX_DIM << " " << PGM_MAX_DIM << "\n255\n" << string(1000, 'x');
+    vector<future<PGMReadResult> > single;
+    for (size_t k = 0; k < paths.size(); k += 7)
+        single.push_back(io.ReadPGMImageAsync(paths[k].c_str()));
+    future<PGMReadResult> missing_read = io.ReadPGMImageAsync(missing.c_str());
+    future<PGMReadResult> bad_read = io.ReadPGMImageAsync(not_pgm.c_str());
+    future<PGMReadResult> oversized_read = io.ReadPGMImageAsync(oversized.c_str());
+    for (size_t s = 0; s < single.size(); s++){
+        PGMReadResult out = single[s].get();
+        errors += CheckRead(out, images[s*7], rows, cols);
+    }
+    PGMReadResult out = missing_read.get();
+    if (out.result != OPEN_ERROR || out.data != 0)
+        errors++;
+    out = bad_read.get();
+    if (out.result == SUCCESS || out.data != 0)
+        errors++;
+    delete[] out.data;
+    out = oversized_read.get();
+    if (out.result != OVERSIZED || out.data != 0)
+        errors++;
+    delete[] out.data;
+    remove(not_pgm.c_str());
+    remove(oversized.c_str());
+    return errors;
+}
+
+// Lee files con un ImageLoader de io_threads hilos y consumers consumidores,
+// repetitions veces. La imagen k-ésima tiene que ser expected[k], de sides[k]
+// filas y columnas. Devuelve el número de errores.
+static long CheckLoader(const vector<string> & files, const vector<vector<unsigned char> > & expected,
+                        const vector<int> & sides, int io_threads, int consumers, int repetitions){
+    long errors = 0;
+    for (int r = 0; r < repetitions; r++){
+        ImageLoader loader(files, io_threads);
+        vector<int> seen(files.size(), 0);
+        mutex seen_lock;
+        vector<thread> workers;
+        for (int c = 0; c < consumers; c++)
+            workers.push_back(thread([&]{
+                LoadedImage item;
+                while (loader.Next(item)){
+                    const vector<unsigned char> & pixels = expected[item.index];
+                    int side = sides[item.index];
+                    bool ok = item.result == SUCCESS && item.image.get_rows() == side && item.image.get_cols() == side;
+                    for (size_t k = 0; ok && k < pixels.size(); k++)
+                        ok = item.image.get_pixel(k) == pixels[k];
+                    lock_guard<mutex> guard(seen_lock);
+                    seen[item.index]++;
+                    errors += !ok;
+                }
+            }));
+        for (size_t c = 0; c < workers.size(); c++)
+            workers[c].join();
+        for (size_t k = 0; k < seen.size(); k++)
+            errors += seen[k] != 1;
+    }
+    return errors;
+}
+
+int main(int argc, char *argv[]){
+
+    int count = 256, side = 256;
+    string tmp_dir = ".";
+
+    // Comprobar validez de la llamada
+    if (argc > 4){
+        cerr << "Error: Numero incorrecto de parametros.\n";
+        cerr << "Uso: async_bench [<imagenes> [<lado> [<directorio_temporal>]]]\n";
+        exit (1);
+    }
+    if (argc > 1)
+        count = atoi(argv[1]);
+    if (argc > 2)
+        side = atoi(argv[2]);
+    if (argc > 3)
+        tmp_dir = argv[3];
+    if (count < 1 || side < 1 || side >= 5000){
+        cerr << "Error: El numero de imagenes debe ser positivo y el lado estar entre 1 y 4999.\n";
+        exit (1);
+    }
+
+    vector<string> paths;
+    vector<vector<unsigned char> > images;
+    for (int k = 0; k < count; k++){
+        paths.push_back(tmp_dir + "/async_bench.tmp." + to_string(k) + ".pgm");
+        images.push_back(MakePixels(k, side, side));
+    }
+
+    cout << "Imagenes: " << count << " de " << side << "x" << side << endl;
+    cout << endl;
+
+    long errors = 0;
+    double write_s, read_s;
+    cout << setw(12) << "" << setw(16) << "escritura" << setw(16) << "lectura" << "  (imagenes/s)" << endl;
+    cout << fixed << setprecision(0);
+    for (AsyncPGMIO::Backend backend : {AsyncPGMIO::IO_URING, AsyncPGMIO::THREAD_POOL}){
+        errors += Check(backend, paths, images, side, side, tmp_dir, write_s, read_s);
+        cout << setw(12) << BackendName(backend) << setw(16) << count / write_s << setw(16) << count / read_s << endl;
+    }
+
+    // Referencia: E/S síncrona de una en una
+    chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+    for (int k = 0; k < count; k++)
+        if (!WritePGMImage(paths[k].c_str(), images[k].data(), side, side))
+            errors++;
+    write_s = Seconds(t0);
+    t0 = chrono::steady_clock::now();
+    for (int k = 0; k < count; k++){
+        PGMReadResult out;
+        out.data = 0;
+        out.result = LoadPGMImage(paths[k].c_str(), out.data, out.rows, out.cols);
+        errors += CheckRead(out, images[k], side, side);
+    }
+    read_s = Seconds(t0);
+    cout << setw(12) << "sincrona" << setw(16) << count / write_s << setw(16) << count / read_s << endl;
+
+    // ImageLoader con varios consumidores: todo el lote, y muchas veces una lista
+    // más corta que el número de consumidores, con una imagen grande para que los
+    // que no reciben ninguna estén esperando al entregarse la última
+    t0 = chrono::steady_clock::now();
+    errors += CheckLoader(paths, images, vector<int>(count, side), 2, 4, 1);
+    read_s = Seconds(t0);
+    cout << setw(12) << "ImageLoader" << setw(16) << "-" << setw(16) << count / read_s << endl;
+
+    const int big_side = 1024;
+    string big_path = tmp_dir + "/async_bench.tmp.big.pgm";
+    vector<vector<unsigned char> > short_images(1, images[0]);
+    short_images.push_back(images[count > 1 ? 1 : 0]);
+    short_images.push_back(MakePixels(count, big_side, big_side));
+    vector<string> short_list(1, paths[0]);
+    short_list.push_back(paths[count > 1 ? 1 : 0]);
+    short_list.push_back(big_path);
+    vector<int> short_sides(2, side);
+    short_sides.push_back(big_side);
+    if (!WritePGMImage(big_path.c_str(), short_images[2].data(), big_side, big_side))
+        errors++;
+    errors += CheckLoader(short_list, short_images, short_sides, 2, 4, 200);
+    remove(big_path.c_str());
+
+    for (int k = 0; k < count; k++)
+        remove(paths[k].c_str());
+
+    cout << endl << "Comprobacion: " << errors << " errores" << endl;
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+/**
+ * @file compare.cpp
+ * @brief Fichero que permite comparar dos imágenes, o dos directorios de imágenes, con el método Compare.
+ *
+ * Si se dan dos directorios, se compara cada imagen .pgm o .pgb del primero con la
+ * imagen del mismo nombre del segundo, y las imágenes que sólo están en el segundo
+ * cuentan como diferencias. Devuelve 0 si todas las imágenes son idénticas, 1 si
+ * alguna difiere o falta y 2 si alguna no pudo leerse.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <cstdlib>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include <image.h>
+#include <imageloader.h>
+
+using namespace std;
+
+static bool IsDirectory(const char * path){
+    struct stat info;
+    return stat(path, &info) == 0 && S_ISDIR(info.st_mode);
+}
+
+static bool Exists(const string & path){
+    struct stat info;
+    return stat(path.c_str(), &info) == 0;
+}
+
+// Nombre del archivo sin el directorio
+static string BaseName(const string & path){
+    return path.substr(path.find_last_of('/') + 1);
+}
+
+// Compara dos archivos e informa del resultado. Devuelve 0, 1 o 2 como el programa.
+static int ComparePair(const string & a, const string & b, bool quiet){
+    Image first, second;
+    LoadResult load_result = first.LoadWithStatus(a.c_str());
+    if (load_result == SUCCESS)
+        load_result = second.LoadWithStatus(b.c_str());
+    if (load_result != SUCCESS){
+        cerr << "Error: No pudo leerse la imagen (" << LoadResultMessage(load_result) << "): "
+             << (first.Empty() ? a : b) << endl;
+        return 2;
+    }
+
+    ImageDiff diff = first.Compare(second);
+    if (diff.equal()){
+        if (!quiet)
+            cout << a << " = " << b << endl;
+        return 0;
+    }
+
+    cout << a << " != " << b << endl;
+    if (!diff.same_size){
+        cout << "   Dimensiones       = " << first.get_rows() << "x" << first.get_cols() << " frente a "
+             << second.get_rows() << "x" << second.get_cols() << endl;
+        return 1;
+    }
+    cout << "   Pixeles distintos = " << diff.mismatches << " de " << first.size() << endl;
+    cout << "   Primer distinto   = fila " << diff.first_row << ", columna " << diff.first_col << endl;
+    cout << "   Diferencia maxima = " << diff.max_diff << endl;
+    cout << "   SSE               = " << diff.sse << endl;
+    cout << "   PSNR              = " << fixed << setprecision(2) << diff.psnr << " dB" << endl;
+    return 1;
+}
+
+int main (int argc, char *argv[]){
+
+    bool quiet = argc > 1 && strcmp(argv[1], "-q") == 0;
+    int arg = quiet ? 2 : 1;
+
+    // Comprobar validez de la llamada
+    if (argc != arg + 2){
+        cerr << "Error: Numero incorrecto de parametros.\n";
+        cerr << "Uso: compare [-q] <FichImagenA_o_DirA> <FichImagenB_o_DirB>\n";
+        exit (2);
+    }
+
+    const char * a = argv[arg];
+    const char * b = argv[arg + 1];
+
+    if (!IsDirectory(a))
+        return ComparePair(a, b, quiet);
+
+    // Directorios: cada imagen de a con la del mismo nombre en b
+    vector<string> files = ExpandImagePaths(vector<string>(1, a));
+    set<string> names;
+    int status = 0, differ = 0, only_a = 0;
+    for (size_t k = 0; k < files.size(); k++){
+        string name = BaseName(files[k]);
+        string other = string(b) + "/" + name;
+        names.insert(name);
+        // Las imágenes de a que no están en b son diferencias, no errores de lectura
+        if (!Exists(other)){
+            cout << files[k] << " no existe en " << b << endl;
+            only_a++;
+            continue;
+        }
+        int res = ComparePair(files[k], other, quiet);
+        status = max(status, res);
+        differ += res != 0;
+    }
+    if (only_a > 0)
+        status = max(status, 1);
+
+    // Las imágenes de b que no están en a también son diferencias
+    int missing = 0;
+    if (IsDirectory(b)){
+        vector<string> others = ExpandImagePaths(vector<string>(1, b));
+        for (size_t k = 0; k < others.size(); k++)
+            if (names.count(BaseName(others[k])) == 0){
+                cout << others[k] << " no existe en " << a << endl;
+                missing++;
+            }
+    }
+    if (missing > 0)
+        status = max(status, 1);
+
+    cout << files.size() - only_a << " imagenes comparadas, " << differ << " distintas";
+    if (only_a > 0)
+        cout << ", " << only_a << " solo en " << a;
+    if (missing > 0)
+        cout << ", " << missing << " solo en " << b;
+    cout << "." << endl;
+    return status;
+}
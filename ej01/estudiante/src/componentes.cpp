@@ -0,0 +1,95 @@
+/**
+ * @file componentes.cpp
+ * @brief Fichero que permite contar las componentes conexas de una imagen umbralizada con la clase ImageLabels.
+ *
+ * Muestra el número de componentes y, de las de mayor área, su área, el rectángulo
+ * que las contiene y su valor medio.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include <image.h>
+#include <imagelabels.h>
+
+using namespace std;
+
+// Componentes que se muestran
+static const int SHOWN_COMPONENTS = 10;
+
+int main (int argc, char *argv[]){
+
+    char *origen; // nombre del fichero
+    int umbral = 128, vecindad = 8;
+    Image image;
+
+    // Comprobar validez de la llamada
+    if (argc < 2 || argc > 4){
+        cerr << "Error: Numero incorrecto de parametros.\n";
+        cerr << "Uso: componentes <FichImagen> [<umbral> [<vecindad>]]\n";
+        exit (1);
+    }
+
+    // Obtener argumentos
+    origen = argv[1];
+    if (argc > 2)
+        umbral = atoi(argv[2]);
+    if (argc > 3)
+        vecindad = atoi(argv[3]);
+    if (umbral < 0 || umbral > 255 || (vecindad != 4 && vecindad != 8)){
+        cerr << "Error: El umbral debe estar entre 0 y 255 y la vecindad debe ser 4 u 8.\n";
+        exit (1);
+    }
+
+    // Mostramos argumentos
+    cout << endl;
+    cout << "Fichero origen: " << origen << endl;
+    cout << "Umbral: " << umbral << endl;
+    cout << "Vecindad: " << vecindad << endl;
+
+    // Leer la imagen del fichero de entrada
+    LoadResult load_result = image.LoadWithStatus(origen);
+    if (load_result != SUCCESS){
+        cerr << "Error: No pudo leerse la imagen (" << LoadResultMessage(load_result) << ")." << endl;
+        cerr << "Terminando la ejecucion del programa." << endl;
+        return 1;
+    }
+
+    // Mostrar los parametros de la Imagen
+    cout << endl;
+    cout << "Dimensiones de " << origen << ":" << endl;
+    cout << "   Imagen   = " << image.get_rows()  << " filas x " << image.get_cols() << " columnas " << endl;
+
+    // Etiquetar
+    int threads = max(1u, thread::hardware_concurrency());
+    ImageLabels labels(image, umbral, vecindad, threads);
+    cout << "   Componentes = " << labels.count() << endl;
+
+    // Las de mayor área primero; a igual área, por etiqueta
+    vector<int> order(labels.count());
+    for (int k = 0; k < labels.count(); k++)
+        order[k] = k + 1;
+    int shown = min(SHOWN_COMPONENTS, labels.count());
+    partial_sort(order.begin(), order.begin() + shown, order.end(), [&labels](int a, int b){
+        long area_a = labels.component(a).area, area_b = labels.component(b).area;
+        return area_a != area_b ? area_a > area_b : a < b;
+    });
+
+    if (shown > 0){
+        cout << endl;
+        cout << setw(10) << "etiqueta" << setw(10) << "area" << setw(8) << "fila" << setw(8) << "columna"
+             << setw(8) << "filas" << setw(9) << "columnas" << setw(9) << "media" << endl;
+    }
+    for (int k = 0; k < shown; k++){
+        const ComponentStats & c = labels.component(order[k]);
+        cout << setw(10) << order[k] << setw(10) << c.area << setw(8) << c.row << setw(8) << c.col
+             << setw(8) << c.height << setw(9) << c.width << setw(9) << fixed << setprecision(0) << c.mean << endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,76 @@
+/**
+ * @file comprimir.cpp
+ * @brief Fichero que permite convertir una imagen entre los formatos PGM y PGB (PGM comprimido por bloques).
+ *
+ * La imagen de origen puede estar en cualquiera de los dos formatos. El formato del
+ * resultado se elige por su extensión: PGM si acaba en .pgm y PGB en otro caso.
+ */
+
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <string>
+
+#include <sys/stat.h>
+
+#include <image.h>
+
+using namespace std;
+
+// Tamaño en bytes de un archivo, o -1 si no existe
+static long FileSize(const char * path){
+    struct stat info;
+    return stat(path, &info) == 0 ? (long)info.st_size : -1;
+}
+
+int main (int argc, char *argv[]){
+
+    char *origen, *destino; // nombres de los ficheros
+    Image image;
+
+    // Comprobar validez de la llamada
+    if (argc != 3){
+        cerr << "Error: Numero incorrecto de parametros.\n";
+        cerr << "Uso: comprimir <FichImagenOriginal> <FichImagenDestino>\n";
+        exit (1);
+    }
+
+    // Obtener argumentos
+    origen  = argv[1];
+    destino = argv[2];
+
+    string nombre = destino;
+    bool pgm = nombre.size() > 4 && nombre.compare(nombre.size() - 4, 4, ".pgm") == 0;
+
+    // Mostramos argumentos
+    cout << endl;
+    cout << "Fichero origen: " << origen << endl;
+    cout << "Fichero resultado: " << destino << " (" << (pgm ? "PGM" : "PGB") << ")" << endl;
+
+    // Leer la imagen del fichero de entrada
+    LoadResult load_result = image.LoadWithStatus(origen);
+    if (load_result != SUCCESS){
+        cerr << "Error: No pudo leerse la imagen (" << LoadResultMessage(load_result) << ")." << endl;
+        cerr << "Terminando la ejecucion del programa." << endl;
+        return 1;
+    }
+
+    // Mostrar los parametros de la Imagen
+    cout << endl;
+    cout << "Dimensiones de " << origen << ":" << endl;
+    cout << "   Imagen   = " << image.get_rows()  << " filas x " << image.get_cols() << " columnas " << endl;
+
+    // Guardar la imagen resultado en el fichero
+    bool saved = pgm ? image.Save(destino) : image.SaveCompressed(destino);
+    if (saved){
+        cout  << "La imagen se guardo en " << destino << endl;
+        cout  << "   Tamaño   = " << FileSize(origen) << " -> " << FileSize(destino) << " bytes" << endl;
+    }
+    else{
+        cerr << "Error: No pudo guardarse la imagen." << endl;
+        cerr << "Terminando la ejecucion del programa." << endl;
+        return 1;
+    }
+
+    return 0;
+}
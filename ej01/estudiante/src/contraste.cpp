@@ -42,8 +42,9 @@ int main (int argc, char *argv[]){
     cout << "S2: " << s2 << endl ;
 
     // Leer la imagen del fichero de entrada
-    if (!image.Load(origen)){
-        cerr << "Error: No pudo leerse la imagen." << endl;
+    LoadResult load_result = image.LoadWithStatus(origen);
+    if (load_result != SUCCESS){
+        cerr << "Error: No pudo leerse la imagen (" << LoadResultMessage(load_result) << ")." << endl;
         cerr << "Terminando la ejecucion del programa." << endl;
         return 1;
     }
@@ -7,9 +7,11 @@
 #include <cstring>
 #include <cassert>
 #include <iostream>
+#include <vector>
 
 #include <image.h>
 #include <imageIO.h>
+#include <imageperf.h>
 
 using namespace std;
 
@@ -44,8 +46,26 @@ void Image::Initialize (int nrows, int ncols, byte * buffer){
 
 void Image::Copy(const Image & orig){
     Initialize(orig.rows,orig.cols);
-    for (int k=0; k<rows*cols;k++)
-        set_pixel(k,orig.get_pixel(k));
+    CopyPixels(orig);
+}
+
+// Función auxiliar para copiar los píxeles entre imágenes de igual tamaño
+void Image::CopyPixels(const Image & orig){
+    if (Empty())
+        return;
+
+    if (Contiguous() && orig.Contiguous())
+        memcpy(img[0], orig.img[0], (size_t)rows * cols);
+    else
+        for (int i=0; i<rows; i++)
+            memcpy(img[i], orig.img[i], cols);
+}
+
+bool Image::Contiguous() const{
+    for (int i=1; i<rows; i++)
+        if (img[i] != img[0] + (size_t)i * cols)
+            return false;
+    return true;
 }
 
 // Función auxiliar para destruir objetos Imagen
@@ -60,15 +80,18 @@ void Image::Destroy(){
     }
 }
 
-LoadResult Image::LoadFromPGM(const char * file_path){
-    if (ReadImageKind(file_path) != IMG_PGM)
-        return LoadResult::NOT_PGM;
+LoadResult Image::LoadFromFile(const char * file_path){
+    int nrows, ncols;
+    byte * buffer;
 
-    byte * buffer = ReadPGMImage(file_path, rows, cols);
-    if (!buffer)
-        return LoadResult::READING_ERROR;
+    // Una sola apertura del archivo para el tipo, la cabecera y los píxeles
+    LoadResult res = LoadImageFile(file_path, buffer, nrows, ncols);
+    if (res != LoadResult::SUCCESS){
+        Initialize();
+        return res;
+    }
 
-    Initialize(rows, cols, buffer);
+    Initialize(nrows, ncols, buffer);
     return LoadResult::SUCCESS;
 }
 
@@ -85,12 +108,39 @@ Image::Image(){
 // Constructores con parámetros
 Image::Image (int nrows, int ncols, byte value){
     Initialize(nrows, ncols);
-    for (int k=0; k<rows*cols; k++) set_pixel(k,value);
+    if (!Empty())
+        memset(img[0], value, (size_t)rows * cols);
 }
 
 bool Image::Load (const char * file_path) {
+    return LoadWithStatus(file_path) == LoadResult::SUCCESS;
+}
+
+LoadResult Image::LoadWithStatus (const char * file_path) {
+    IMAGE_PERF_SCOPE("Load");
     Destroy();
-    return LoadFromPGM(file_path) == LoadResult::SUCCESS;
+    return LoadFromFile(file_path);
+}
+
+LoadResult Image::LoadRegion (const char * file_path, int nrow, int ncol, int height, int width,
+                              int & file_rows, int & file_cols) {
+    IMAGE_PERF_SCOPE("LoadRegion");
+    Destroy();
+
+    byte * buffer;
+    LoadResult res = LoadImageRegion(file_path, nrow, ncol, height, width, buffer, file_rows, file_cols);
+    if (res != LoadResult::SUCCESS || buffer == 0){
+        Initialize();
+        return res;
+    }
+
+    Initialize(height, width, buffer);
+    return LoadResult::SUCCESS;
+}
+
+LoadResult Image::LoadRegion (const char * file_path, int nrow, int ncol, int height, int width) {
+    int file_rows, file_cols;
+    return LoadRegion(file_path, nrow, ncol, height, width, file_rows, file_cols);
 }
 
 // Constructor de copias
@@ -100,6 +150,15 @@ Image::Image (const Image & orig){
     Copy(orig);
 }
 
+// Constructor de movimiento
+
+Image::Image (Image && orig) noexcept {
+    rows = orig.rows;
+    cols = orig.cols;
+    img = orig.img;
+    orig.Initialize();
+}
+
 // Destructor
 
 Image::~Image(){
@@ -109,9 +168,24 @@ Image::~Image(){
 // Operador de Asignación
 
 Image & Image::operator= (const Image & orig){
+    if (this != &orig){
+        if (rows == orig.rows && cols == orig.cols)
+            CopyPixels(orig);
+        else {
+            Destroy();
+            Copy(orig);
+        }
+    }
+    return *this;
+}
+
+Image & Image::operator= (Image && orig) noexcept {
     if (this != &orig){
         Destroy();
-        Copy(orig);
+        rows = orig.rows;
+        cols = orig.cols;
+        img = orig.img;
+        orig.Initialize();
     }
     return *this;
 }
@@ -156,13 +230,24 @@ byte Image::get_pixel (int k) const {
 
 // Métodos para almacenar y cargar imagenes en disco
 bool Image::Save (const char * file_path) const {
-    // TODO this makes assumptions about the internal representation
-    //byte * p = img[0];
-    byte * p;
-    p = new byte [get_rows() * get_cols()];
-
-    for(int i=0; i<this->size(); i++)
-        p[i] = get_pixel(i);
-
-    return WritePGMImage(file_path, p, rows, cols);
+    IMAGE_PERF_SCOPE("Save");
+    // Con las filas consecutivas se escribe directamente desde la imagen
+    if (Empty() || Contiguous())
+        return WritePGMImage(file_path, Empty() ? 0 : img[0], rows, cols);
+
+    vector<byte> p((size_t)rows * cols);
+    for (int i=0; i<rows; i++)
+        memcpy(&p[(size_t)i * cols], img[i], cols);
+    return WritePGMImage(file_path, p.data(), rows, cols);
+}
+
+bool Image::SaveCompressed (const char * file_path) const {
+    IMAGE_PERF_SCOPE("SaveCompressed");
+    if (Empty() || Contiguous())
+        return WritePGBImage(file_path, Empty() ? 0 : img[0], rows, cols);
+
+    vector<byte> p((size_t)rows * cols);
+    for (int i=0; i<rows; i++)
+        memcpy(&p[(size_t)i * cols], img[i], cols);
+    return WritePGBImage(file_path, p.data(), rows, cols);
 }
\ No newline at end of file
@@ -2,7 +2,7 @@
   * @file imageIO.cpp
   * @brief Fichero con definiciones para la E/S de imágenes
   *
-  * Permite la E/S de archivos de tipo PGM,PPM
+  * Permite la E/S de archivos de tipo PGM,PPM y PGB
   *
   */
 
@@ -11,6 +11,18 @@
 #include <imageIO.h>
 
 #include <fstream>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <queue>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 using namespace std;
 
 
@@ -25,6 +37,7 @@ ImageKind ReadKind(ifstream& f){
       switch (c2) {
         case '5': res= IMG_PGM; break;
         case '6': res= IMG_PPM; break;
+        case 'G': res= (f.get()=='B' && f.get()=='1' && f) ? IMG_PGB : IMG_UNKNOWN; break;
         default: res= IMG_UNKNOWN;
       }
   }
@@ -41,52 +54,843 @@ ImageKind ReadImageKind(const char *nombre){
 
 // _____________________________________________________________________________
 
-char SkipWhitespaces (ifstream& f){
-  char c;
+// Tamaño del primer bloque leído del archivo: debe contener la cabecera completa
+static const size_t HEADER_CHUNK = PGM_HEADER_CHUNK;
+
+// Lee hasta n bytes, reintentando lecturas parciales. Devuelve los bytes
+// leídos (menos de n sólo al llegar al final del archivo) o -1 si hay error.
+static ssize_t ReadFully (int fd, unsigned char *buf, size_t n){
+  size_t total= 0;
+  while (total < n){
+    ssize_t r= read(fd, buf+total, n-total);
+    if (r < 0){
+      if (errno == EINTR)
+        continue;
+      return -1;
+    }
+    if (r == 0)
+      break;
+    total+= r;
+  }
+  return total;
+}
+
+// _____________________________________________________________________________
+
+// Lee un número de la cabecera, saltando antes separadores y comentarios.
+// Devuelve false si no hay un número completo antes de @a n.
+static bool ReadHeaderNumber (const unsigned char *buf, size_t n, size_t& pos,
+                              long& value, bool& malformed){
+  malformed= false;
+  while (pos < n && (isspace(buf[pos]) || buf[pos] == '#')){
+    if (buf[pos] == '#')
+      while (pos < n && buf[pos] != '\n')
+        pos++;
+    else
+      pos++;
+  }
+  if (pos >= n)
+    return false;
+  if (!isdigit(buf[pos])){
+    malformed= true;
+    return false;
+  }
+  value= 0;
+  while (pos < n && isdigit(buf[pos])){
+    if (value < 1000000000L)
+      value= value*10 + (buf[pos]-'0');
+    pos++;
+  }
+  return pos < n;
+}
+
+// _____________________________________________________________________________
+
+LoadResult ParsePGMHeader (const unsigned char *buf, size_t n,
+                           int& rows, int& cols, size_t& offset){
+  if (n < 2 || buf[0] != 'P' || buf[1] != '5')
+    return NOT_PGM;
+
+  // Si la cabecera no acaba dentro del bloque: archivo cortado o cabecera enorme
+  LoadResult incomplete= n < HEADER_CHUNK ? TRUNCATED : BAD_HEADER;
+
+  size_t pos= 2;
+  long values[3];
+  for (int k=0; k<3; k++){
+    bool malformed;
+    if (!ReadHeaderNumber(buf, n, pos, values[k], malformed))
+      return malformed ? BAD_HEADER : incomplete;
+  }
+  if (!isspace(buf[pos]))
+    return BAD_HEADER;
+
+  cols= values[0];
+  rows= values[1];
+  if (rows <= 0 || cols <= 0 || values[2] <= 0 || values[2] > 255)
+    return BAD_HEADER;
+  if (rows >= PGM_MAX_DIM || cols >= PGM_MAX_DIM)
+    return OVERSIZED;
+
+  offset= pos+1; // Saltamos separador
+  return SUCCESS;
+}
+
+// _____________________________________________________________________________
+
+// Lee una imagen PGM de la que ya se han leído los @a n primeros bytes en @a head
+static LoadResult LoadPGMFrom (int fd, const unsigned char *head, ssize_t n,
+                               unsigned char *&data, int& rows, int& cols){
+  int r= 0, c= 0;
+  size_t offset= 0;
+  LoadResult res= n < 0 ? READING_ERROR : ParsePGMHeader(head, n, r, c, offset);
+
+  if (res == SUCCESS){
+    // Los píxeles ya leídos junto a la cabecera se copian; el resto se lee
+    // directamente sobre el buffer de salida
+    size_t total= (size_t)r*c;
+    size_t have= min(total, (size_t)n - offset);
+    data= new unsigned char[total];
+    memcpy(data, head+offset, have);
+    if (have < total){
+      ssize_t m= ReadFully(fd, data+have, total-have);
+      if (m < 0)
+        res= READING_ERROR;
+      else if ((size_t)m < total-have)
+        res= TRUNCATED;
+    }
+    if (res == SUCCESS){
+      rows= r;
+      cols= c;
+    }
+    else{
+      delete[] data;
+      data= 0;
+    }
+  }
+  return res;
+}
+
+// _____________________________________________________________________________
+
+LoadResult LoadPGMImage (const char *path, unsigned char *&data, int& rows, int& cols){
+  data= 0;
+  rows= 0;
+  cols= 0;
+
+  int fd= open(path, O_RDONLY);
+  if (fd < 0)
+    return OPEN_ERROR;
+
+  unsigned char head[HEADER_CHUNK];
+  ssize_t n= ReadFully(fd, head, sizeof(head));
+  LoadResult res= LoadPGMFrom(fd, head, n, data, rows, cols);
+  close(fd);
+  return res;
+}
+
+/********************************
+        CONTENEDOR PGB
+********************************/
+
+static const unsigned char PGB_MAGIC[4] = {'P', 'G', 'B', '1'};
+static const size_t PGB_HEADER_SIZE = 20;
+static const size_t PGB_ENTRY_SIZE = 13;
+
+// Método de compresión de cada bloque
+enum PGBMethod {PGB_STORED, PGB_LZ, PGB_DELTA_LZ, PGB_MED_HUFFMAN};
+
+// Entrada del índice de bloques
+struct PGBBlock{
+  uint64_t offset;
+  uint32_t size;
+  unsigned char method;
+};
+
+// Cabecera e índice de un archivo PGB
+struct PGBHeader{
+  int rows, cols, band_rows;
+  vector<PGBBlock> blocks;
+};
+
+// A partir de este tamaño los bloques se descomprimen en varios hilos
+static const size_t PGB_PARALLEL_BYTES = 1 << 20;
+
+static void PutU32 (unsigned char *p, uint32_t v){
+  for (int k=0; k<4; k++)
+    p[k]= v >> (8*k);
+}
+
+static uint32_t GetU32 (const unsigned char *p){
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// _____________________________________________________________________________
+
+// Códec LZ de bytes con secuencias al estilo de LZ4. Cada secuencia es un token
+// con la longitud de los literales (4 bits altos) y la de la coincidencia menos
+// LZ_MIN_MATCH (4 bits bajos); si alguna vale 15 se extiende con bytes de 255
+// más un resto. Tras el token van los literales, la distancia de la coincidencia
+// (16 bits) y la extensión de su longitud. La última secuencia sólo lleva
+// literales y acaba con la entrada.
+
+static const size_t LZ_MIN_MATCH = 4;
+static const int LZ_HASH_BITS = 14;
+static const size_t LZ_MAX_DISTANCE = 65535;
+
+static void PutLength (vector<unsigned char>& out, size_t len){
+  while (len >= 255){
+    out.push_back(255);
+    len-= 255;
+  }
+  out.push_back(len);
+}
+
+static uint32_t Load32 (const unsigned char *p){
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static void LZCompress (const unsigned char *in, size_t n, vector<unsigned char>& out){
+  vector<int64_t> table(1 << LZ_HASH_BITS, -1);
+  size_t anchor= 0, i= 0;
+
+  while (i + LZ_MIN_MATCH <= n){
+    uint32_t seq= Load32(in+i);
+    uint32_t h= (seq * 2654435761u) >> (32 - LZ_HASH_BITS);
+    int64_t cand= table[h];
+    table[h]= i;
+    if (cand < 0 || i - cand > LZ_MAX_DISTANCE || Load32(in+cand) != seq){
+      i++;
+      continue;
+    }
+
+    size_t len= LZ_MIN_MATCH;
+    while (i+len < n && in[cand+len] == in[i+len])
+      len++;
+
+    size_t lits= i - anchor;
+    size_t extra= len - LZ_MIN_MATCH;
+    out.push_back((min(lits, (size_t)15) << 4) | min(extra, (size_t)15));
+    if (lits >= 15)
+      PutLength(out, lits-15);
+    out.insert(out.end(), in+anchor, in+i);
+    out.push_back((i-cand) & 0xff);
+    out.push_back((i-cand) >> 8);
+    if (extra >= 15)
+      PutLength(out, extra-15);
+
+    i+= len;
+    anchor= i;
+  }
+
+  size_t lits= n - anchor;
+  out.push_back(min(lits, (size_t)15) << 4);
+  if (lits >= 15)
+    PutLength(out, lits-15);
+  out.insert(out.end(), in+anchor, in+n);
+}
+
+// Lee la extensión de una longitud. Devuelve false si se acaba la entrada.
+static bool GetLength (const unsigned char *&ip, const unsigned char *end, size_t& len){
+  unsigned char b;
   do{
-    c= f.get();
-  } while (isspace(c));
-  f.putback(c);
-  return c;
+    if (ip == end)
+      return false;
+    b= *ip++;
+    len+= b;
+  } while (b == 255);
+  return true;
+}
+
+// Descomprime exactamente @a n bytes. Devuelve false si la entrada no es válida.
+static bool LZDecompress (const unsigned char *in, size_t size, unsigned char *out, size_t n){
+  const unsigned char *ip= in, *end= in+size;
+  unsigned char *op= out, *oend= out+n;
+
+  while (ip < end){
+    unsigned char token= *ip++;
+    size_t lits= token >> 4;
+    if (lits == 15 && !GetLength(ip, end, lits))
+      return false;
+    if (lits > (size_t)(end-ip) || lits > (size_t)(oend-op))
+      return false;
+    memcpy(op, ip, lits);
+    op+= lits;
+    ip+= lits;
+
+    if (ip == end)
+      break;
+
+    if (end-ip < 2)
+      return false;
+    size_t dist= ip[0] | (ip[1] << 8);
+    ip+= 2;
+    size_t len= token & 15;
+    if (len == 15 && !GetLength(ip, end, len))
+      return false;
+    len+= LZ_MIN_MATCH;
+    if (dist == 0 || dist > (size_t)(op-out) || len > (size_t)(oend-op))
+      return false;
+
+    // Si la coincidencia se solapa con lo que se escribe, se copia byte a byte
+    const unsigned char *match= op - dist;
+    if (dist >= len)
+      memcpy(op, match, len);
+    else
+      for (size_t k=0; k<len; k++)
+        op[k]= match[k];
+    op+= len;
+  }
+  return op == oend;
 }
 
 // _____________________________________________________________________________
 
-bool ReadHeader (ifstream& f, int& rows, int& cols){
-    int maxvalor;
-    string linea;
-    while (SkipWhitespaces(f) == '#')
-      getline(f,linea);
-    f >> cols >> rows >> maxvalor;
-    
-    if (/*str &&*/ f && rows>0 && rows<5000 && cols>0 && cols<5000){
-        f.get(); // Saltamos separador
-        return true;
+// Filtro delta: cada píxel pasa a ser su diferencia con el vecino izquierdo, y
+// el primero de cada fila, con el primero de la fila anterior del bloque
+static void DeltaEncode (const unsigned char *in, unsigned char *out, int rows, int cols){
+  for (int i=0; i<rows; i++){
+    const unsigned char *p= in + (size_t)i*cols;
+    unsigned char *d= out + (size_t)i*cols;
+    d[0]= p[0] - (i > 0 ? p[-cols] : 0);
+    for (int j=1; j<cols; j++)
+      d[j]= p[j] - p[j-1];
+  }
+}
+
+static void DeltaDecode (unsigned char *buf, int rows, int cols){
+  for (int i=0; i<rows; i++){
+    unsigned char *p= buf + (size_t)i*cols;
+    if (i > 0)
+      p[0]+= p[-cols];
+    for (int j=1; j<cols; j++)
+      p[j]+= p[j-1];
+  }
+}
+
+// _____________________________________________________________________________
+
+// Predictor MED (LOCO-I) con los vecinos izquierdo (a), superior (b) y
+// superior izquierdo (c). En la primera fila y columna del bloque se predice
+// con el único vecino disponible.
+static inline unsigned char MedPredict (const unsigned char *p, int i, int j, int cols){
+  if (i == 0)
+    return j > 0 ? p[-1] : 0;
+  if (j == 0)
+    return p[-cols];
+  int a= p[-1], b= p[-cols], c= p[-cols-1];
+  int lo= min(a, b), hi= max(a, b);
+  if (c >= hi)
+    return lo;
+  if (c <= lo)
+    return hi;
+  return a + b - c;
+}
+
+// Códigos de Huffman canónicos de como mucho HUFF_MAX_BITS bits, escritos del
+// bit menos significativo al más significativo para decodificar con una tabla
+// indexada por los siguientes HUFF_MAX_BITS bits de la entrada.
+static const int HUFF_MAX_BITS = 12;
+static const size_t HUFF_LENGTHS_SIZE = 128;  // 256 longitudes de 4 bits
+
+static void HuffmanLengths (const size_t freq[256], unsigned char len[256]){
+  vector<size_t> f(freq, freq+256);
+  while (true){
+    typedef pair<size_t,int> Node;  // peso, nodo
+    priority_queue<Node, vector<Node>, greater<Node> > q;
+    int parent[512];
+    int next= 256;
+    for (int s=0; s<256; s++)
+      if (f[s] > 0)
+        q.push(Node(f[s], s));
+
+    memset(len, 0, 256);
+    if (q.size() == 1){
+      len[q.top().second]= 1;
+      return;
+    }
+    while (q.size() > 1){
+      Node a= q.top(); q.pop();
+      Node b= q.top(); q.pop();
+      parent[a.second]= parent[b.second]= next;
+      q.push(Node(a.first + b.first, next++));
     }
-    else 
+    int root= next-1, longest= 0;
+    for (int s=0; s<256; s++)
+      if (f[s] > 0){
+        int depth= 0;
+        for (int k=s; k != root; k= parent[k])
+          depth++;
+        len[s]= depth;
+        longest= max(longest, depth);
+      }
+    if (longest <= HUFF_MAX_BITS)
+      return;
+
+    // Códigos demasiado largos: se aplanan las frecuencias y se repite
+    for (int s=0; s<256; s++)
+      if (f[s] > 0)
+        f[s]= (f[s]+1) / 2;
+  }
+}
+
+// Asigna los códigos canónicos, ya invertidos. Devuelve false si las longitudes
+// no forman un código prefijo válido.
+static bool HuffmanCodes (const unsigned char len[256], uint32_t code[256]){
+  int count[HUFF_MAX_BITS+1]= {0};
+  for (int s=0; s<256; s++){
+    if (len[s] > HUFF_MAX_BITS)
       return false;
+    count[len[s]]++;
+  }
+  count[0]= 0;
+
+  uint32_t next[HUFF_MAX_BITS+1];
+  uint32_t c= 0;
+  long kraft= 0;
+  for (int bits=1; bits<=HUFF_MAX_BITS; bits++){
+    c= (c + count[bits-1]) << 1;
+    next[bits]= c;
+    kraft+= (long)count[bits] << (HUFF_MAX_BITS - bits);
+  }
+  if (kraft > (1L << HUFF_MAX_BITS))
+    return false;
+
+  for (int s=0; s<256; s++){
+    code[s]= 0;
+    if (len[s] > 0){
+      uint32_t v= next[len[s]]++, r= 0;
+      for (int k=0; k<len[s]; k++)
+        r|= ((v >> k) & 1) << (len[s]-1-k);
+      code[s]= r;
+    }
+  }
+  return true;
 }
 
+static void MedHuffmanEncode (const unsigned char *in, int rows, int cols, vector<unsigned char>& out){
+  size_t n= (size_t)rows*cols;
+  vector<unsigned char> residual(n);
+  size_t freq[256]= {0};
+  for (int i=0; i<rows; i++)
+    for (int j=0; j<cols; j++){
+      const unsigned char *p= in + (size_t)i*cols + j;
+      unsigned char r= *p - MedPredict(p, i, j, cols);
+      residual[(size_t)i*cols + j]= r;
+      freq[r]++;
+    }
+
+  unsigned char len[256];
+  uint32_t code[256];
+  HuffmanLengths(freq, len);
+  HuffmanCodes(len, code);
 
+  out.reserve(HUFF_LENGTHS_SIZE + n);
+  for (int s=0; s<256; s+=2)
+    out.push_back(len[s] | (len[s+1] << 4));
+
+  uint64_t acc= 0;
+  int nbits= 0;
+  for (size_t k=0; k<n; k++){
+    unsigned char r= residual[k];
+    acc|= (uint64_t)code[r] << nbits;
+    nbits+= len[r];
+    while (nbits >= 8){
+      out.push_back(acc & 0xff);
+      acc>>= 8;
+      nbits-= 8;
+    }
+  }
+  if (nbits > 0)
+    out.push_back(acc & 0xff);
+}
+
+static bool MedHuffmanDecode (const unsigned char *in, size_t size, unsigned char *out, int rows, int cols){
+  if (size < HUFF_LENGTHS_SIZE)
+    return false;
+  unsigned char len[256];
+  uint32_t code[256];
+  for (int s=0; s<256; s+=2){
+    len[s]= in[s/2] & 15;
+    len[s+1]= in[s/2] >> 4;
+  }
+  if (!HuffmanCodes(len, code))
+    return false;
+
+  // Entrada de la tabla: símbolo en los 8 bits bajos y longitud encima (0 si no es válida)
+  vector<uint16_t> table(1 << HUFF_MAX_BITS, 0);
+  for (int s=0; s<256; s++)
+    if (len[s] > 0)
+      for (uint32_t k=code[s]; k < table.size(); k+= 1u << len[s])
+        table[k]= s | (len[s] << 8);
+
+  const unsigned char *ip= in + HUFF_LENGTHS_SIZE, *end= in + size;
+  uint64_t acc= 0;
+  int nbits= 0;
+  size_t padding= 0;  // bytes a cero añadidos tras el final de la entrada
+  for (int i=0; i<rows; i++)
+    for (int j=0; j<cols; j++){
+      while (nbits <= 56){
+        if (ip < end)
+          acc|= (uint64_t)*ip++ << nbits;
+        else
+          padding++;
+        nbits+= 8;
+      }
+      uint16_t e= table[acc & ((1u << HUFF_MAX_BITS) - 1)];
+      int bits= e >> 8;
+      if (bits == 0)
+        return false;
+      acc>>= bits;
+      nbits-= bits;
+
+      unsigned char *p= out + (size_t)i*cols + j;
+      *p= (unsigned char)(e & 0xff) + MedPredict(p, i, j, cols);
+    }
+  // Los bits usados no pueden salir de la entrada real
+  return (size_t)nbits >= padding*8;
+}
 
 // _____________________________________________________________________________
 
-unsigned char *ReadPGMImage (const char *path, int& rows, int& cols){
-  unsigned char *res=0;
-  rows=0;
-  cols=0;
-  ifstream f(path);
-  
-  if (ReadKind(f) == IMG_PGM){
-    if (ReadHeader(f, rows, cols)){
-      res= new unsigned char[rows*cols];
-      f.read(reinterpret_cast<char *>(res),rows*cols);
-      if (!f){
-        delete[] res;
-        res= 0;
+// Descomprime un bloque de @a rows filas sobre @a out
+static bool DecodeBlock (const PGBBlock& b, const unsigned char *in,
+                         unsigned char *out, int rows, int cols){
+  size_t n= (size_t)rows*cols;
+  switch (b.method){
+    case PGB_STORED:
+      if (b.size != n)
+        return false;
+      memcpy(out, in, n);
+      return true;
+    case PGB_LZ:
+      return LZDecompress(in, b.size, out, n);
+    case PGB_DELTA_LZ:
+      if (!LZDecompress(in, b.size, out, n))
+        return false;
+      DeltaDecode(out, rows, cols);
+      return true;
+    case PGB_MED_HUFFMAN:
+      return MedHuffmanDecode(in, b.size, out, rows, cols);
+  }
+  return false;
+}
+
+// _____________________________________________________________________________
+
+// Lee la cabecera y el índice de un PGB. @a head contiene los @a n primeros
+// bytes del archivo y @a file_size es su tamaño total.
+static LoadResult ReadPGBHeader (int fd, const unsigned char *head, size_t n,
+                                 uint64_t file_size, PGBHeader& h){
+  if (n < sizeof(PGB_MAGIC) || memcmp(head, PGB_MAGIC, sizeof(PGB_MAGIC)) != 0)
+    return NOT_PGM;
+  if (n < PGB_HEADER_SIZE)
+    return TRUNCATED;
+
+  uint32_t rows= GetU32(head+4), cols= GetU32(head+8);
+  uint32_t band_rows= GetU32(head+12), nblocks= GetU32(head+16);
+  if (rows == 0 || cols == 0 || band_rows == 0)
+    return BAD_HEADER;
+  if (rows >= (uint32_t)PGM_MAX_DIM || cols >= (uint32_t)PGM_MAX_DIM)
+    return OVERSIZED;
+  // Con band_rows <= rows < PGM_MAX_DIM las filas de cada bloque caben en un int
+  if (band_rows > rows || nblocks != (rows + band_rows - 1) / band_rows)
+    return BAD_HEADER;
+
+  h.rows= rows;
+  h.cols= cols;
+  h.band_rows= band_rows;
+
+  // El índice puede no caber en el bloque inicial ya leído
+  size_t index_size= (size_t)nblocks * PGB_ENTRY_SIZE;
+  vector<unsigned char> index(index_size);
+  size_t have= min(index_size, n - PGB_HEADER_SIZE);
+  memcpy(index.data(), head+PGB_HEADER_SIZE, have);
+  if (have < index_size){
+    ssize_t m= pread(fd, index.data()+have, index_size-have, PGB_HEADER_SIZE+have);
+    if (m < 0)
+      return READING_ERROR;
+    if ((size_t)m < index_size-have)
+      return TRUNCATED;
+  }
+
+  h.blocks.resize(nblocks);
+  for (uint32_t k=0; k<nblocks; k++){
+    const unsigned char *e= index.data() + (size_t)k*PGB_ENTRY_SIZE;
+    PGBBlock& b= h.blocks[k];
+    b.offset= GetU32(e) | ((uint64_t)GetU32(e+4) << 32);
+    b.size= GetU32(e+8);
+    b.method= e[12];
+    if (b.method > PGB_MED_HUFFMAN)
+      return CORRUPT;
+    if (b.offset > file_size || b.size > file_size - b.offset)
+      return TRUNCATED;
+  }
+  return SUCCESS;
+}
+
+// _____________________________________________________________________________
+
+// Lee y descomprime las filas [first, first+count) de un PGB del que ya se han
+// leído los @a n primeros bytes en @a head
+static LoadResult LoadPGBFrom (int fd, const unsigned char *head, ssize_t n,
+                               int first, int count,
+                               unsigned char *&data, int& rows, int& cols){
+  struct stat info;
+  if (n < 0 || fstat(fd, &info) != 0)
+    return READING_ERROR;
+
+  PGBHeader h;
+  LoadResult res= ReadPGBHeader(fd, head, n, info.st_size, h);
+  if (res != SUCCESS)
+    return res;
+
+  int last= (int)min((long)h.rows, (long)first + count);
+  if (first >= last){
+    rows= h.rows;
+    cols= h.cols;
+    return SUCCESS;
+  }
+
+  // Los bloques pedidos se leen con una sola lectura, desde el menor
+  // desplazamiento hasta el final del último bloque
+  int b0= first / h.band_rows, b1= (last-1) / h.band_rows;
+  uint64_t start= h.blocks[b0].offset, stop= start;
+  for (int b=b0; b<=b1; b++){
+    start= min(start, h.blocks[b].offset);
+    stop= max(stop, h.blocks[b].offset + h.blocks[b].size);
+  }
+  vector<unsigned char> packed(stop - start);
+  ssize_t m= pread(fd, packed.data(), packed.size(), start);
+  if (m < 0)
+    return READING_ERROR;
+  if ((size_t)m < packed.size())
+    return TRUNCATED;
+
+  // Cada hilo descomprime bloques alternos. Los bloques de los extremos de los
+  // que sólo se piden algunas filas se descomprimen en un buffer aparte.
+  unsigned char *out= new unsigned char[(size_t)(last-first) * h.cols];
+  int nblocks= b1-b0+1;
+  int nthreads= 1;
+  if ((size_t)(last-first) * h.cols >= PGB_PARALLEL_BYTES)
+    nthreads= max(1, min((int)thread::hardware_concurrency(), min(nblocks, 8)));
+
+  vector<char> ok(nblocks, 1);
+  auto decode= [&](int t){
+    vector<unsigned char> band;
+    for (int b=b0+t; b<=b1; b+=nthreads){
+      const PGBBlock& blk= h.blocks[b];
+      long r0= (long)b*h.band_rows, r1= min((long)h.rows, r0 + h.band_rows);
+      const unsigned char *in= packed.data() + (blk.offset - start);
+      if (r0 >= first && r1 <= last)
+        ok[b-b0]= DecodeBlock(blk, in, out + (size_t)(r0-first)*h.cols, r1-r0, h.cols);
+      else{
+        band.resize((size_t)(r1-r0)*h.cols);
+        ok[b-b0]= DecodeBlock(blk, in, band.data(), r1-r0, h.cols);
+        long lo= max(r0, (long)first), hi= min(r1, (long)last);
+        memcpy(out + (size_t)(lo-first)*h.cols, band.data() + (size_t)(lo-r0)*h.cols,
+               (size_t)(hi-lo)*h.cols);
+      }
+    }
+  };
+  vector<thread> workers;
+  for (int t=1; t<nthreads; t++)
+    workers.push_back(thread(decode, t));
+  decode(0);
+  for (size_t t=0; t<workers.size(); t++)
+    workers[t].join();
+
+  if (find(ok.begin(), ok.end(), 0) != ok.end()){
+    delete[] out;
+    return CORRUPT;
+  }
+
+  data= out;
+  rows= h.rows;
+  cols= h.cols;
+  return SUCCESS;
+}
+
+// _____________________________________________________________________________
+
+LoadResult LoadPGBRows (const char *path, int first, int count,
+                        unsigned char *&data, int& rows, int& cols){
+  data= 0;
+  rows= 0;
+  cols= 0;
+
+  int fd= open(path, O_RDONLY);
+  if (fd < 0)
+    return OPEN_ERROR;
+
+  unsigned char head[HEADER_CHUNK];
+  ssize_t n= ReadFully(fd, head, sizeof(head));
+  LoadResult res= LoadPGBFrom(fd, head, n, first, count, data, rows, cols);
+  close(fd);
+  return res;
+}
+
+// _____________________________________________________________________________
+
+LoadResult LoadPGBImage (const char *path, unsigned char *&data, int& rows, int& cols){
+  return LoadPGBRows(path, 0, PGM_MAX_DIM, data, rows, cols);
+}
+
+// _____________________________________________________________________________
+
+LoadResult LoadImageFile (const char *path, unsigned char *&data, int& rows, int& cols){
+  data= 0;
+  rows= 0;
+  cols= 0;
+
+  int fd= open(path, O_RDONLY);
+  if (fd < 0)
+    return OPEN_ERROR;
+
+  // El formato se reconoce en el mismo bloque inicial que usa cada lector
+  unsigned char head[HEADER_CHUNK];
+  ssize_t n= ReadFully(fd, head, sizeof(head));
+  LoadResult res;
+  if (n >= (ssize_t)sizeof(PGB_MAGIC) && memcmp(head, PGB_MAGIC, sizeof(PGB_MAGIC)) == 0)
+    res= LoadPGBFrom(fd, head, n, 0, PGM_MAX_DIM, data, rows, cols);
+  else
+    res= LoadPGMFrom(fd, head, n, data, rows, cols);
+  close(fd);
+  return res;
+}
+
+// _____________________________________________________________________________
+
+// Las filas de una región PGM se leen con una sola lectura si lo que se lee de
+// más entre ellas no pasa de este tamaño por fila
+static const size_t REGION_MAX_GAP = 4096;
+
+LoadResult LoadImageRegion (const char *path, int row, int col, int height, int width,
+                            unsigned char *&data, int& rows, int& cols){
+  data= 0;
+  rows= 0;
+  cols= 0;
+
+  int fd= open(path, O_RDONLY);
+  if (fd < 0)
+    return OPEN_ERROR;
+
+  unsigned char head[HEADER_CHUNK];
+  ssize_t n= ReadFully(fd, head, sizeof(head));
+  bool pgb= n >= (ssize_t)sizeof(PGB_MAGIC) && memcmp(head, PGB_MAGIC, sizeof(PGB_MAGIC)) == 0;
+  bool outside= row < 0 || col < 0 || height < 0 || width < 0;
+  LoadResult res;
+
+  if (pgb){
+    // Se descomprimen las filas completas de la región y se recortan en su sitio
+    unsigned char *band= 0;
+    res= outside ? BAD_REGION : LoadPGBFrom(fd, head, n, row, height, band, rows, cols);
+    if (res == SUCCESS && ((long)row + height > rows || (long)col + width > cols))
+      res= BAD_REGION;
+    if (res == SUCCESS && (size_t)height*width > 0){
+      for (int i=0; i<height; i++)
+        memmove(band + (size_t)i*width, band + (size_t)i*cols + col, width);
+      data= band;
+    }
+    else
+      delete[] band;
+  }
+  else{
+    int r= 0, c= 0;
+    size_t offset= 0;
+    res= n < 0 ? READING_ERROR : ParsePGMHeader(head, n, r, c, offset);
+    if (res == SUCCESS && (outside || (long)row + height > r || (long)col + width > c))
+      res= BAD_REGION;
+
+    if (res == SUCCESS && (size_t)height*width > 0){
+      unsigned char *out= new unsigned char[(size_t)height*width];
+      off_t first= offset + (size_t)row*c + col;
+      size_t gap= c - width;
+      if (gap <= REGION_MAX_GAP || height == 1){
+        // Una lectura desde el primer píxel de la región hasta el último
+        size_t span= (size_t)(height-1)*c + width;
+        unsigned char *buf= gap == 0 ? out : new unsigned char[span];
+        ssize_t m= pread(fd, buf, span, first);
+        if (m < 0)
+          res= READING_ERROR;
+        else if ((size_t)m < span)
+          res= TRUNCATED;
+        else if (buf != out)
+          for (int i=0; i<height; i++)
+            memcpy(out + (size_t)i*width, buf + (size_t)i*c, width);
+        if (buf != out)
+          delete[] buf;
       }
+      else
+        for (int i=0; i<height && res == SUCCESS; i++){
+          ssize_t m= pread(fd, out + (size_t)i*width, width, first + (off_t)i*c);
+          if (m < 0)
+            res= READING_ERROR;
+          else if (m < width)
+            res= TRUNCATED;
+        }
+
+      if (res == SUCCESS)
+        data= out;
+      else
+        delete[] out;
+    }
+    if (res == SUCCESS){
+      rows= r;
+      cols= c;
     }
   }
+
+  close(fd);
+  return res;
+}
+
+// _____________________________________________________________________________
+
+LoadResult ParsePGMBuffer (unsigned char *buf, size_t n, int& rows, int& cols){
+  rows= 0;
+  cols= 0;
+
+  // La cabecera se busca en el mismo bloque inicial que en LoadPGMImage
+  int r= 0, c= 0;
+  size_t offset= 0;
+  LoadResult res= ParsePGMHeader(buf, min(n, HEADER_CHUNK), r, c, offset);
+  if (res != SUCCESS)
+    return res;
+
+  size_t total= (size_t)r*c;
+  if (n - offset < total)
+    return TRUNCATED;
+
+  memmove(buf, buf+offset, total);
+  rows= r;
+  cols= c;
+  return SUCCESS;
+}
+
+// _____________________________________________________________________________
+
+const char *LoadResultMessage (LoadResult result){
+  switch (result){
+    case SUCCESS:       return "imagen leida correctamente";
+    case NOT_PGM:       return "el archivo no es una imagen PGM (P5)";
+    case READING_ERROR: return "error de lectura";
+    case OPEN_ERROR:    return "no se pudo abrir el archivo";
+    case BAD_HEADER:    return "cabecera PGM no valida";
+    case OVERSIZED:     return "dimensiones de la imagen demasiado grandes";
+    case TRUNCATED:     return "archivo incompleto, faltan pixeles";
+    case CORRUPT:       return "bloque comprimido no valido";
+    case BAD_REGION:    return "region fuera de la imagen";
+  }
+  return "error desconocido";
+}
+
+// _____________________________________________________________________________
+
+unsigned char *ReadPGMImage (const char *path, int& rows, int& cols){
+  unsigned char *res=0;
+  LoadPGMImage(path, res, rows, cols);
   return res;
 }
 
@@ -95,19 +899,84 @@ unsigned char *ReadPGMImage (const char *path, int& rows, int& cols){
 bool WritePGMImage (const char *nombre, const unsigned char *datos,
                     const int rows, const int cols){
   ofstream f(nombre);
-  bool res= true;
+  bool res= false;
   
   if (f){
     f << "P5" << endl;
     f << cols << ' ' << rows << endl;
     f << 255 << endl;
     f.write(reinterpret_cast<const char *>(datos),rows*cols);
-    if (!f)
-      res=false;
+    res= (bool)f;
   }
   return res;
 }
 
+// _____________________________________________________________________________
+
+bool WritePGBImage (const char *nombre, const unsigned char *datos,
+                    const int rows, const int cols, int band_rows){
+  if (band_rows <= 0)
+    band_rows= max(1, PGB_BLOCK_BYTES / max(cols, 1));
+  band_rows= max(1, min(band_rows, rows));
+  int nblocks= (rows + band_rows - 1) / band_rows;
+
+  // Cada bloque se guarda con el método que menos ocupe
+  vector<vector<unsigned char> > packed(nblocks);
+  vector<unsigned char> methods(nblocks);
+  vector<unsigned char> delta, lz;
+  for (int b=0; b<nblocks; b++){
+    int r0= b*band_rows, r1= min(rows, r0 + band_rows);
+    const unsigned char *band= datos + (size_t)r0*cols;
+    size_t n= (size_t)(r1-r0)*cols;
+
+    delta.resize(n);
+    DeltaEncode(band, delta.data(), r1-r0, cols);
+    LZCompress(delta.data(), n, packed[b]);
+    methods[b]= PGB_DELTA_LZ;
+
+    lz.clear();
+    LZCompress(band, n, lz);
+    if (lz.size() < packed[b].size()){
+      packed[b].swap(lz);
+      methods[b]= PGB_LZ;
+    }
+    lz.clear();
+    MedHuffmanEncode(band, r1-r0, cols, lz);
+    if (lz.size() < packed[b].size()){
+      packed[b].swap(lz);
+      methods[b]= PGB_MED_HUFFMAN;
+    }
+    if (packed[b].size() >= n){
+      packed[b].assign(band, band+n);
+      methods[b]= PGB_STORED;
+    }
+  }
+
+  vector<unsigned char> header(PGB_HEADER_SIZE + (size_t)nblocks*PGB_ENTRY_SIZE);
+  memcpy(header.data(), PGB_MAGIC, sizeof(PGB_MAGIC));
+  PutU32(&header[4], rows);
+  PutU32(&header[8], cols);
+  PutU32(&header[12], band_rows);
+  PutU32(&header[16], nblocks);
+  uint64_t offset= header.size();
+  for (int b=0; b<nblocks; b++){
+    unsigned char *e= &header[PGB_HEADER_SIZE + (size_t)b*PGB_ENTRY_SIZE];
+    PutU32(e, offset);
+    PutU32(e+4, offset >> 32);
+    PutU32(e+8, packed[b].size());
+    e[12]= methods[b];
+    offset+= packed[b].size();
+  }
+
+  ofstream f(nombre, ios::binary);
+  if (!f)
+    return false;
+  f.write(reinterpret_cast<const char *>(header.data()), header.size());
+  for (int b=0; b<nblocks; b++)
+    f.write(reinterpret_cast<const char *>(packed[b].data()), packed[b].size());
+  return (bool)f;
+}
+
 
 /* Fin Fichero: imagenES.cpp */
 
@@ -0,0 +1,352 @@
+/**
+ * @file image_bench.cpp
+ * @brief Banco de pruebas de rendimiento para todas las operaciones de la clase Image.
+ *
+ * Mide cada operación sobre imágenes de distintos tamaños y proporciones, con
+ * ejecuciones de calentamiento, varias repeticiones, mediana, percentiles y
+ * rendimiento en MB/s. La salida puede ser una tabla, CSV o JSON, y puede
+ * compararse con un CSV anterior para medir cada cambio frente a una referencia.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <map>
+#include <memory>
+#include <functional>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+
+#include <image.h>
+#include <imageperf.h>
+#include <imageexpr.h>
+#include <imagepyramid.h>
+#include <imagelabels.h>
+
+using namespace std;
+
+/**
+  * @brief Caso de prueba: una operación sobre una imagen de un tamaño concreto.
+  */
+struct BenchCase {
+    string op;                               ///< Nombre de la operación
+    string param;                            ///< Parámetros de la operación
+    int rows;                                ///< Filas de la imagen de entrada
+    int cols;                                ///< Columnas de la imagen de entrada
+    function<void(Image &)> run;             ///< Operación a medir sobre la imagen de entrada
+    function<void(Image &)> setup = nullptr; ///< Preparación previa, fuera de la medición (opcional)
+};
+
+/**
+  * @brief Resultado de medir un caso de prueba.
+  */
+struct BenchResult {
+    BenchCase c;                    ///< Caso medido
+    int trials;                     ///< Número de repeticiones medidas
+    int iters;                      ///< Ejecuciones de la operación por repetición
+    double min_us;                  ///< Tiempo mínimo por ejecución (microsegundos)
+    double p10_us;                  ///< Percentil 10
+    double median_us;               ///< Mediana
+    double p90_us;                  ///< Percentil 90
+    double mb_s;                    ///< Rendimiento (MB/s de la imagen de entrada) sobre la mediana
+};
+
+typedef chrono::steady_clock bench_clock;
+
+// Percentil por el método del rango más cercano sobre un vector ordenado
+static double Percentile(const vector<double> & sorted, double pct){
+    if (sorted.empty())
+        return 0;
+    size_t k = (size_t)(pct / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[min(k, sorted.size() - 1)];
+}
+
+// Imagen de entrada con contenido no uniforme (para que ninguna rama sea trivial)
+static Image MakeInput(int rows, int cols){
+    Image img(rows, cols);
+    for (int i = 0; i < rows; i++)
+        for (int j = 0; j < cols; j++)
+            img.set_pixel(i, j, (byte)((i * 7 + j * 13 + (i ^ j)) & 0xFF));
+    return img;
+}
+
+static double ElapsedUs(bench_clock::time_point a, bench_clock::time_point b){
+    return chrono::duration<double, micro>(b - a).count();
+}
+
+static BenchResult RunCase(const BenchCase & c, int warmup, int trials, double min_trial_us){
+    Image input = MakeInput(c.rows, c.cols);
+    if (c.setup)
+        c.setup(input);
+
+    // Calentamiento y calibrado: cada repetición debe durar al menos min_trial_us
+    double one_us = 0;
+    for (int w = 0; w < max(warmup, 1); w++){
+        bench_clock::time_point t0 = bench_clock::now();
+        c.run(input);
+        one_us = ElapsedUs(t0, bench_clock::now());
+    }
+    int iters = one_us > 0 ? (int)(min_trial_us / one_us) : 1;
+    iters = max(1, min(iters, 100000));
+
+    vector<double> samples;
+    for (int t = 0; t < trials; t++){
+        bench_clock::time_point t0 = bench_clock::now();
+        for (int k = 0; k < iters; k++)
+            c.run(input);
+        samples.push_back(ElapsedUs(t0, bench_clock::now()) / iters);
+    }
+    sort(samples.begin(), samples.end());
+
+    BenchResult r;
+    r.c = c;
+    r.trials = trials;
+    r.iters = iters;
+    r.min_us = samples.front();
+    r.p10_us = Percentile(samples, 10);
+    r.median_us = Percentile(samples, 50);
+    r.p90_us = Percentile(samples, 90);
+    r.mb_s = r.median_us > 0 ? ((double)c.rows * c.cols) / r.median_us : 0;   // bytes/us == MB/s
+    return r;
+}
+
+static string Key(const BenchCase & c){
+    ostringstream os;
+    os << c.op << "|" << c.param << "|" << c.rows << "|" << c.cols;
+    return os.str();
+}
+
+// Lee la mediana de cada caso de un CSV generado previamente con --format csv
+static map<string, double> ReadBaseline(const char * path){
+    map<string, double> base;
+    ifstream f(path);
+    string line;
+    getline(f, line);   // cabecera
+    while (getline(f, line)){
+        vector<string> fields;
+        string field;
+        istringstream ls(line);
+        while (getline(ls, field, ','))
+            fields.push_back(field);
+        if (fields.size() < 7)
+            continue;
+        BenchCase c;
+        c.op = fields[0];
+        c.param = fields[1];
+        c.rows = atoi(fields[2].c_str());
+        c.cols = atoi(fields[3].c_str());
+        base[Key(c)] = atof(fields[6].c_str());
+    }
+    return base;
+}
+
+static vector<BenchCase> MakeCases(const string & tmp_dir, bool quick){
+    // Tamaños cuadrados y con distintas proporciones (alto x ancho)
+    vector<pair<int,int> > sizes;
+    sizes.push_back(make_pair(64, 64));
+    sizes.push_back(make_pair(256, 256));
+    sizes.push_back(make_pair(1024, 1024));
+    sizes.push_back(make_pair(64, 4096));
+    sizes.push_back(make_pair(4096, 64));
+    sizes.push_back(make_pair(768, 2048));
+    if (!quick)
+        sizes.push_back(make_pair(4096, 4096));
+
+    const int factors[] = {2, 3, 4, 8};
+    const string tmp_file = tmp_dir + "/image_bench.tmp.pgm";
+    const string tmp_pgb = tmp_dir + "/image_bench.tmp.pgb";
+
+    vector<BenchCase> cases;
+    for (size_t s = 0; s < sizes.size(); s++){
+        int r = sizes[s].first, c = sizes[s].second;
+
+        cases.push_back({"Invert", "", r, c, [](Image & img){ img.Invert(); }});
+        cases.push_back({"AdjustContrast", "50:200:10:240", r, c,
+                         [](Image & img){ img.AdjustContrast(50, 200, 10, 240); }});
+        cases.push_back({"Mean", "full", r, c,
+                         [](Image & img){ volatile double m = img.Mean(0, 0, img.get_rows(), img.get_cols()); (void)m; }});
+        for (int f : factors)
+            if (r / f > 0 && c / f > 0)
+                cases.push_back({"Subsample", to_string(f), r, c,
+                                 [f](Image & img){ Image icon = img.Subsample(f); }});
+        cases.push_back({"Zoom2X", "", r, c, [](Image & img){ Image z = img.Zoom2X(); }});
+        // Giro de 3 grados alrededor del centro
+        for (WarpSampling sampling : {WARP_NEAREST, WARP_BILINEAR})
+            cases.push_back({"Warp", sampling == WARP_NEAREST ? "nearest" : "bilinear", r, c, [sampling](Image & img){
+                AffineTransform t = AffineTransform::Rotation(3, img.get_rows() / 2.0, img.get_cols() / 2.0);
+                Image warped = img.Warp(t, sampling);
+            }});
+        cases.push_back({"Crop", "half", r, c, [](Image & img){
+            Image sub = img.Crop(img.get_rows() / 4, img.get_cols() / 4, img.get_rows() / 2, img.get_cols() / 2); }});
+        cases.push_back({"ShuffleRows", "", r, c, [](Image & img){ img.ShuffleRows(); }});
+
+        // Cadena de tono: una pasada por operación frente a la expresión diferida
+        cases.push_back({"Tone", "eager", r, c, [](Image & img){
+            Image out = img;
+            out.Invert();
+            out.AdjustContrast(50, 200, 10, 240);
+            out.Invert();
+        }});
+        cases.push_back({"Tone", "lazy", r, c, [](Image & img){
+            Image out = img.lazy().invert().contrast(50, 200, 10, 240).invert().eval();
+        }});
+
+        // Comparación con una copia que difiere en un píxel
+        shared_ptr<Image> other = make_shared<Image>();
+        cases.push_back({"Compare", "", r, c, [other](Image & img){ ImageDiff d = img.Compare(*other); (void)d; },
+                         [other](Image & img){ *other = img; other->set_pixel(0, 0, ~img.get_pixel(0, 0)); }});
+
+        // Componentes conexas de la imagen umbralizada, en un hilo y por bandas
+        for (int threads : {1, 4})
+            cases.push_back({"Label", to_string(threads) + "t", r, c, [threads](Image & img){
+                ImageLabels labels(img, 128, 8, threads);
+            }});
+
+        // Todos los niveles de la pirámide: Subsample desde el original frente a
+        // cada nivel a partir del anterior
+        cases.push_back({"Pyramid", "direct", r, c, [](Image & img){
+            for (int f = 2; img.get_rows() / f > 0 && img.get_cols() / f > 0; f *= 2)
+                Image level = img.Subsample(f);
+        }});
+        cases.push_back({"Pyramid", "cascade", r, c, [](Image & img){ ImagePyramid pyramid(img); }});
+
+        // La lectura de PGM limita cada dimensión a menos de 5000
+        if (r < 5000 && c < 5000){
+            cases.push_back({"Save", "", r, c, [tmp_file](Image & img){ img.Save(tmp_file.c_str()); }});
+            cases.push_back({"Load", "", r, c, [tmp_file](Image &){
+                Image loaded;
+                loaded.Load(tmp_file.c_str());
+            }, [tmp_file](Image & img){ img.Save(tmp_file.c_str()); }});
+            cases.push_back({"LoadRegion", "quarter", r, c, [tmp_file](Image & img){
+                Image tile;
+                tile.LoadRegion(tmp_file.c_str(), img.get_rows() / 2, img.get_cols() / 2,
+                                img.get_rows() / 4, img.get_cols() / 4);
+            }, [tmp_file](Image & img){ img.Save(tmp_file.c_str()); }});
+            cases.push_back({"Save", "pgb", r, c, [tmp_pgb](Image & img){ img.SaveCompressed(tmp_pgb.c_str()); }});
+            cases.push_back({"Load", "pgb", r, c, [tmp_pgb](Image &){
+                Image loaded;
+                loaded.Load(tmp_pgb.c_str());
+            }, [tmp_pgb](Image & img){ img.SaveCompressed(tmp_pgb.c_str()); }});
+        }
+    }
+    return cases;
+}
+
+static void PrintUsage(){
+    cerr << "Uso: image_bench [--format table|csv|json] [--trials N] [--warmup N]\n"
+         << "                 [--min-trial-ms T] [--filter OP] [--tmp DIR] [--quick]\n"
+         << "                 [--baseline FICHERO.csv] [--perf]\n";
+}
+
+int main(int argc, char *argv[]){
+
+    string format = "table", filter, tmp_dir = ".";
+    const char * baseline_path = 0;
+    int trials = 15, warmup = 3;
+    double min_trial_ms = 2;
+    bool quick = false, perf = false;
+
+    // Obtener argumentos
+    for (int i = 1; i < argc; i++){
+        string a = argv[i];
+        bool has_value = i + 1 < argc;
+        if (a == "--format" && has_value) format = argv[++i];
+        else if (a == "--trials" && has_value) trials = max(1, atoi(argv[++i]));
+        else if (a == "--warmup" && has_value) warmup = max(0, atoi(argv[++i]));
+        else if (a == "--min-trial-ms" && has_value) min_trial_ms = atof(argv[++i]);
+        else if (a == "--filter" && has_value) filter = argv[++i];
+        else if (a == "--tmp" && has_value) tmp_dir = argv[++i];
+        else if (a == "--baseline" && has_value) baseline_path = argv[++i];
+        else if (a == "--quick") quick = true;
+        else if (a == "--perf") perf = true;
+        else {
+            PrintUsage();
+            return 1;
+        }
+    }
+    if (format != "table" && format != "csv" && format != "json"){
+        PrintUsage();
+        return 1;
+    }
+
+#ifndef __OPTIMIZE__
+    cerr << "Aviso: image_bench compilado sin optimizaciones (use -DCMAKE_BUILD_TYPE=Release)" << endl;
+#endif
+
+    map<string, double> baseline;
+    if (baseline_path)
+        baseline = ReadBaseline(baseline_path);
+
+    vector<BenchCase> cases = MakeCases(tmp_dir, quick);
+    vector<BenchResult> results;
+    for (size_t k = 0; k < cases.size(); k++)
+        if (filter.empty() || cases[k].op == filter)
+            results.push_back(RunCase(cases[k], warmup, trials, min_trial_ms * 1000));
+    remove((tmp_dir + "/image_bench.tmp.pgm").c_str());
+    remove((tmp_dir + "/image_bench.tmp.pgb").c_str());
+
+    cout << fixed << setprecision(3);
+    if (format == "csv"){
+        cout << "op,param,rows,cols,trials,min_us,median_us,p10_us,p90_us,mb_s" << endl;
+        for (const BenchResult & r : results)
+            cout << r.c.op << "," << r.c.param << "," << r.c.rows << "," << r.c.cols << ","
+                 << r.trials << "," << r.min_us << "," << r.median_us << ","
+                 << r.p10_us << "," << r.p90_us << "," << r.mb_s << endl;
+    }
+    else if (format == "json"){
+        cout << "[" << endl;
+        for (size_t k = 0; k < results.size(); k++){
+            const BenchResult & r = results[k];
+            cout << "  {\"op\": \"" << r.c.op << "\", \"param\": \"" << r.c.param << "\", "
+                 << "\"rows\": " << r.c.rows << ", \"cols\": " << r.c.cols << ", "
+                 << "\"trials\": " << r.trials << ", \"min_us\": " << r.min_us << ", "
+                 << "\"median_us\": " << r.median_us << ", \"p10_us\": " << r.p10_us << ", "
+                 << "\"p90_us\": " << r.p90_us << ", \"mb_s\": " << r.mb_s << "}"
+                 << (k + 1 < results.size() ? "," : "") << endl;
+        }
+        cout << "]" << endl;
+    }
+    else {
+        cout << left << setw(16) << "op" << setw(16) << "param" << right
+             << setw(12) << "size" << setw(14) << "median_us" << setw(14) << "p10_us"
+             << setw(14) << "p90_us" << setw(12) << "MB/s";
+        if (!baseline.empty())
+            cout << setw(10) << "speedup";
+        cout << endl;
+        for (const BenchResult & r : results){
+            ostringstream size;
+            size << r.c.rows << "x" << r.c.cols;
+            cout << left << setw(16) << r.c.op << setw(16) << r.c.param << right
+                 << setw(12) << size.str() << setw(14) << r.median_us << setw(14) << r.p10_us
+                 << setw(14) << r.p90_us << setw(12) << r.mb_s;
+            if (!baseline.empty()){
+                map<string, double>::const_iterator it = baseline.find(Key(r.c));
+                if (it != baseline.end() && r.median_us > 0)
+                    cout << setw(9) << it->second / r.median_us << "x";
+                else
+                    cout << setw(10) << "-";
+            }
+            cout << endl;
+        }
+    }
+
+    // Informe de contadores hardware por operación (ver imageperf.h)
+    if (perf){
+        if (!PerfEnabled())
+            cerr << "Aviso: --perf requiere compilar con -DIMAGE_PERF_COUNTERS=ON" << endl;
+        else {
+            if (!PerfCountersAvailable())
+                cerr << "Aviso: contadores hardware no disponibles, sólo se muestran tiempos" << endl;
+            cerr << endl;
+            PerfReport(cerr);
+        }
+    }
+
+    return 0;
+}
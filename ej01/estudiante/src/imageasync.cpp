@@ -0,0 +1,555 @@
+/**
+  * @file imageasync.cpp
+  * @brief Fichero con definiciones para la E/S asíncrona de imágenes PGM
+  *
+  * Con io_uring, la apertura y el cierre de cada archivo son síncronos y la
+  * lectura o escritura de su contenido se envía al anillo. Cada lectura lee antes
+  * de forma síncrona el bloque de la cabecera, para no reservar memoria para
+  * archivos que no son PGM o superan PGM_MAX_DIM, y pide al anillo la cabecera y
+  * los píxeles, que se comprueban al completarse con ParsePGMBuffer. Cada
+  * escritura envía la cabecera y los
+  * píxeles en un único writev.
+  *
+  */
+
+#include <imageasync.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+using namespace std;
+
+// Operación en curso en io_uring
+struct AsyncPGMIO::Request{
+    bool write;
+    int fd;
+    string path;
+
+    // Lectura: cabecera y píxeles
+    unsigned char *buffer;
+    size_t size;
+    ReadCallback on_read;
+
+    // Escritura: cabecera + píxeles
+    char header[32];
+    struct iovec iov[2];
+    WriteCallback on_write;
+};
+
+#ifdef __linux__
+
+// Anillos de envío y compleción de io_uring, proyectados en memoria
+struct AsyncPGMIO::Ring{
+    int fd;
+    void *sq_ptr, *cq_ptr;
+    size_t sq_len, cq_len;
+    struct io_uring_sqe *sqes;
+    size_t sqes_len;
+
+    unsigned *sq_tail, *sq_mask, *sq_array;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_cqe *cqes;
+    unsigned sq_entries, cq_entries;
+
+    mutex lock;                 // protege local_tail, queued e inflight
+    condition_variable space;   // avisa de que inflight ha bajado
+    unsigned local_tail;        // siguiente entrada libre del anillo de envío
+    unsigned queued;            // entradas preparadas y aún no enviadas
+    unsigned inflight;          // entradas enviadas sin compleción
+};
+
+static int RingEnter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags){
+    return syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+#else
+
+struct AsyncPGMIO::Ring{};
+
+#endif
+
+// _____________________________________________________________________________
+
+// Completa con llamadas síncronas una lectura o escritura que io_uring dejó a medias
+static ssize_t FinishRead(int fd, unsigned char *buf, size_t n, size_t done){
+    while (done < n){
+        ssize_t r = pread(fd, buf+done, n-done, done);
+        if (r < 0 && errno == EINTR)
+            continue;
+        if (r <= 0)
+            break;
+        done += r;
+    }
+    return done;
+}
+
+static bool FinishWrite(int fd, const struct iovec iov[2], size_t done){
+    size_t offset = 0;
+    for (int k=0; k<2; k++){
+        const unsigned char *base = static_cast<const unsigned char *>(iov[k].iov_base);
+        size_t len = iov[k].iov_len;
+        while (done < offset+len){
+            size_t from = done-offset;
+            ssize_t w = pwrite(fd, base+from, len-from, done);
+            if (w < 0 && errno == EINTR)
+                continue;
+            if (w <= 0)
+                return false;
+            done += w;
+        }
+        offset += len;
+    }
+    return true;
+}
+
+/********************************
+      FUNCIONES PRIVADAS
+********************************/
+
+bool AsyncPGMIO::SetupRing(unsigned entries){
+#ifdef __linux__
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int fd = syscall(__NR_io_uring_setup, entries, &params);
+    if (fd < 0)
+        return false;
+
+    Ring *r = new Ring;
+    r->fd = fd;
+    r->sq_len = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    r->cq_len = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    r->sqes_len = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    r->sq_ptr = mmap(0, r->sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    r->cq_ptr = mmap(0, r->cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    void *sqes = mmap(0, r->sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (r->sq_ptr == MAP_FAILED || r->cq_ptr == MAP_FAILED || sqes == MAP_FAILED){
+        if (r->sq_ptr != MAP_FAILED) munmap(r->sq_ptr, r->sq_len);
+        if (r->cq_ptr != MAP_FAILED) munmap(r->cq_ptr, r->cq_len);
+        if (sqes != MAP_FAILED) munmap(sqes, r->sqes_len);
+        close(fd);
+        delete r;
+        return false;
+    }
+
+    char *sq = static_cast<char *>(r->sq_ptr);
+    char *cq = static_cast<char *>(r->cq_ptr);
+    r->sqes = static_cast<struct io_uring_sqe *>(sqes);
+    r->sq_tail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    r->sq_mask = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    r->sq_array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    r->cq_head = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    r->cq_tail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    r->cq_mask = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    r->cqes = reinterpret_cast<struct io_uring_cqe *>(cq + params.cq_off.cqes);
+    r->sq_entries = params.sq_entries;
+    r->cq_entries = params.cq_entries;
+    r->local_tail = *r->sq_tail;
+    r->queued = 0;
+    r->inflight = 0;
+
+    ring = r;
+    return true;
+#else
+    (void)entries;
+    return false;
+#endif
+}
+
+// _____________________________________________________________________________
+
+void AsyncPGMIO::Reap(){
+#ifdef __linux__
+    bool done = false;
+    while (!done){
+        if (RingEnter(ring->fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR)
+            break;
+
+        unsigned head = *ring->cq_head;
+        unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+        unsigned count = 0;
+        {
+            // Cada Request se escribió con ring->lock antes de enviarse: tomar el
+            // cerrojo ordena esas escrituras con su lectura en este hilo
+            lock_guard<mutex> guard(ring->lock);
+        }
+
+        for (; head != tail; head++, count++){
+            struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cq_mask];
+            Request *req = reinterpret_cast<Request *>(cqe->user_data);
+            int res = cqe->res;
+
+            // La entrada nula es la señal de fin que envía el destructor
+            if (req == 0){
+                done = true;
+                continue;
+            }
+
+            if (req->write){
+                size_t total = req->iov[0].iov_len + req->iov[1].iov_len;
+                bool ok = res >= 0 && ((size_t)res == total || FinishWrite(req->fd, req->iov, res));
+                ok = close(req->fd) == 0 && ok;
+                req->on_write(ok);
+            }
+            else{
+                PGMReadResult out;
+                out.path = req->path;
+                out.data = 0;
+                out.rows = out.cols = 0;
+                if (res < 0)
+                    out.result = READING_ERROR;
+                else{
+                    size_t n = FinishRead(req->fd, req->buffer, req->size, res);
+                    out.result = ParsePGMBuffer(req->buffer, n, out.rows, out.cols);
+                }
+                close(req->fd);
+                if (out.result == SUCCESS)
+                    out.data = req->buffer;
+                else
+                    delete[] req->buffer;
+                req->on_read(out);
+            }
+            delete req;
+            Finish();
+        }
+        __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+
+        if (count > 0){
+            lock_guard<mutex> guard(ring->lock);
+            ring->inflight -= count;
+            ring->space.notify_all();
+        }
+    }
+#endif
+}
+
+// _____________________________________________________________________________
+
+void AsyncPGMIO::Work(){
+    while (true){
+        function<void()> task;
+        {
+            unique_lock<mutex> guard(lock);
+            task_ready.wait(guard, [this]{ return stopping || !tasks.empty(); });
+            if (tasks.empty())
+                return;
+            task = move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+        Finish();
+    }
+}
+
+// _____________________________________________________________________________
+
+void AsyncPGMIO::Finish(){
+    lock_guard<mutex> guard(lock);
+    if (--pending == 0)
+        idle.notify_all();
+}
+
+// _____________________________________________________________________________
+
+void AsyncPGMIO::Flush(){
+#ifdef __linux__
+    if (!ring)
+        return;
+    lock_guard<mutex> guard(ring->lock);
+    while (ring->queued > 0){
+        int n = RingEnter(ring->fd, ring->queued, 0, 0);
+        if (n < 0){
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+                continue;
+            perror("io_uring_enter");
+            abort();
+        }
+        ring->queued -= n;
+    }
+#endif
+}
+
+// _____________________________________________________________________________
+
+void AsyncPGMIO::Read(const char *path, ReadCallback done, bool flush){
+    {
+        lock_guard<mutex> guard(lock);
+        pending++;
+    }
+
+    if (!ring){
+        string file = path;
+        lock_guard<mutex> guard(lock);
+        tasks.push_back([file, done]{
+            PGMReadResult out;
+            out.path = file;
+            out.result = LoadPGMImage(file.c_str(), out.data, out.rows, out.cols);
+            done(out);
+        });
+        task_ready.notify_one();
+        return;
+    }
+
+#ifdef __linux__
+    PGMReadResult early;
+    early.path = path;
+    early.data = 0;
+    early.rows = early.cols = 0;
+
+    // La cabecera se lee e interpreta antes de reservar el buffer
+    unsigned char head[PGM_HEADER_CHUNK];
+    int rows = 0, cols = 0;
+    size_t offset = 0;
+    int fd = open(path, O_RDONLY);
+    struct stat info;
+    if (fd < 0)
+        early.result = OPEN_ERROR;
+    else if (fstat(fd, &info) != 0)
+        early.result = READING_ERROR;
+    else{
+        size_t n = min((size_t)info.st_size, sizeof(head));
+        early.result = ParsePGMHeader(head, FinishRead(fd, head, n, 0), rows, cols, offset);
+    }
+    if (early.result != SUCCESS){
+        if (fd >= 0)
+            close(fd);
+        done(early);
+        Finish();
+        return;
+    }
+
+    Request *req = new Request;
+    req->write = false;
+    req->fd = fd;
+    req->path = path;
+    req->size = offset + (size_t)rows*cols;
+    req->buffer = new unsigned char[req->size];
+    req->on_read = done;
+    req->iov[0].iov_base = req->buffer;
+    req->iov[0].iov_len = req->size;
+
+    unique_lock<mutex> guard(ring->lock);
+    // Sin hueco en el anillo: se envía lo pendiente y se espera a las compleciones
+    while (ring->inflight >= ring->cq_entries || ring->queued >= ring->sq_entries){
+        guard.unlock();
+        Flush();
+        guard.lock();
+        ring->space.wait(guard, [this]{ return ring->inflight < ring->cq_entries; });
+    }
+
+    unsigned index = ring->local_tail & *ring->sq_mask;
+    struct io_uring_sqe *sqe = &ring->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_READV;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<unsigned long>(req->iov);
+    sqe->len = 1;
+    sqe->off = 0;
+    sqe->user_data = reinterpret_cast<unsigned long>(req);
+    ring->sq_array[index] = index;
+    ring->local_tail++;
+    __atomic_store_n(ring->sq_tail, ring->local_tail, __ATOMIC_RELEASE);
+    ring->queued++;
+    ring->inflight++;
+    guard.unlock();
+
+    if (flush)
+        Flush();
+#endif
+}
+
+// _____________________________________________________________________________
+
+void AsyncPGMIO::Write(const char *path, const unsigned char *data, int rows, int cols,
+                       WriteCallback done, bool flush){
+    {
+        lock_guard<mutex> guard(lock);
+        pending++;
+    }
+
+    if (!ring){
+        string file = path;
+        lock_guard<mutex> guard(lock);
+        tasks.push_back([file, data, rows, cols, done]{
+            done(WritePGMImage(file.c_str(), data, rows, cols));
+        });
+        task_ready.notify_one();
+        return;
+    }
+
+#ifdef __linux__
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0){
+        done(false);
+        Finish();
+        return;
+    }
+
+    Request *req = new Request;
+    req->write = true;
+    req->fd = fd;
+    req->path = path;
+    req->buffer = 0;
+    req->size = 0;
+    req->on_write = done;
+    int header_len = snprintf(req->header, sizeof(req->header), "P5\n%d %d\n255\n", cols, rows);
+    req->iov[0].iov_base = req->header;
+    req->iov[0].iov_len = header_len;
+    req->iov[1].iov_base = const_cast<unsigned char *>(data);
+    req->iov[1].iov_len = (size_t)rows*cols;
+
+    unique_lock<mutex> guard(ring->lock);
+    while (ring->inflight >= ring->cq_entries || ring->queued >= ring->sq_entries){
+        guard.unlock();
+        Flush();
+        guard.lock();
+        ring->space.wait(guard, [this]{ return ring->inflight < ring->cq_entries; });
+    }
+
+    unsigned index = ring->local_tail & *ring->sq_mask;
+    struct io_uring_sqe *sqe = &ring->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_WRITEV;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<unsigned long>(req->iov);
+    sqe->len = 2;
+    sqe->off = 0;
+    sqe->user_data = reinterpret_cast<unsigned long>(req);
+    ring->sq_array[index] = index;
+    ring->local_tail++;
+    __atomic_store_n(ring->sq_tail, ring->local_tail, __ATOMIC_RELEASE);
+    ring->queued++;
+    ring->inflight++;
+    guard.unlock();
+
+    if (flush)
+        Flush();
+#endif
+}
+
+/********************************
+       FUNCIONES PÚBLICAS
+********************************/
+
+AsyncPGMIO::AsyncPGMIO(Backend backend, int threads, unsigned queue_depth)
+    : kind(THREAD_POOL), ring(0), pending(0), stopping(false){
+    if (backend != THREAD_POOL && SetupRing(queue_depth)){
+        kind = IO_URING;
+        reaper = thread(&AsyncPGMIO::Reap, this);
+        return;
+    }
+    for (int k=0; k<threads || k==0; k++)
+        workers.push_back(thread(&AsyncPGMIO::Work, this));
+}
+
+// _____________________________________________________________________________
+
+AsyncPGMIO::~AsyncPGMIO(){
+    Flush();
+    Wait();
+
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    task_ready.notify_all();
+    for (size_t k=0; k<workers.size(); k++)
+        workers[k].join();
+
+#ifdef __linux__
+    if (ring){
+        // Entrada nula para despertar y terminar el hilo de compleciones
+        {
+            lock_guard<mutex> guard(ring->lock);
+            unsigned index = ring->local_tail & *ring->sq_mask;
+            struct io_uring_sqe *sqe = &ring->sqes[index];
+            memset(sqe, 0, sizeof(*sqe));
+            sqe->opcode = IORING_OP_NOP;
+            sqe->user_data = 0;
+            ring->sq_array[index] = index;
+            ring->local_tail++;
+            __atomic_store_n(ring->sq_tail, ring->local_tail, __ATOMIC_RELEASE);
+            ring->queued++;
+            ring->inflight++;
+        }
+        Flush();
+        reaper.join();
+
+        munmap(ring->sqes, ring->sqes_len);
+        munmap(ring->cq_ptr, ring->cq_len);
+        munmap(ring->sq_ptr, ring->sq_len);
+        close(ring->fd);
+        delete ring;
+    }
+#endif
+}
+
+// _____________________________________________________________________________
+
+void AsyncPGMIO::ReadPGMImageAsync(const char *path, ReadCallback done){
+    Read(path, done, true);
+}
+
+future<PGMReadResult> AsyncPGMIO::ReadPGMImageAsync(const char *path){
+    shared_ptr<promise<PGMReadResult> > result = make_shared<promise<PGMReadResult> >();
+    Read(path, [result](PGMReadResult & out){ result->set_value(out); }, true);
+    return result->get_future();
+}
+
+void AsyncPGMIO::WritePGMImageAsync(const char *path, const unsigned char *data, int rows, int cols,
+                                    WriteCallback done){
+    Write(path, data, rows, cols, done, true);
+}
+
+future<bool> AsyncPGMIO::WritePGMImageAsync(const char *path, const unsigned char *data, int rows, int cols){
+    shared_ptr<promise<bool> > result = make_shared<promise<bool> >();
+    Write(path, data, rows, cols, [result](bool ok){ result->set_value(ok); }, true);
+    return result->get_future();
+}
+
+// _____________________________________________________________________________
+
+vector<PGMReadResult> AsyncPGMIO::ReadPGMImages(const vector<string> & paths){
+    vector<PGMReadResult> results(paths.size());
+    mutex done_lock;
+    condition_variable all_done;
+    size_t remaining = paths.size();
+
+    // Todas las lecturas se preparan antes de enviarlas en un único lote
+    for (size_t k=0; k<paths.size(); k++)
+        Read(paths[k].c_str(), [&, k](PGMReadResult & out){
+            results[k] = out;
+            lock_guard<mutex> guard(done_lock);
+            if (--remaining == 0)
+                all_done.notify_all();
+        }, false);
+    Flush();
+
+    unique_lock<mutex> guard(done_lock);
+    all_done.wait(guard, [&]{ return remaining == 0; });
+    return results;
+}
+
+// _____________________________________________________________________________
+
+void AsyncPGMIO::Wait(){
+    Flush();
+    unique_lock<mutex> guard(lock);
+    idle.wait(guard, [this]{ return pending == 0; });
+}
+
+/* Fin Fichero: imageasync.cpp */
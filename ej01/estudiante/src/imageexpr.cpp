@@ -0,0 +1,185 @@
+/**
+ * @file imageexpr.cpp
+ * @brief Fichero con definiciones para los métodos de la clase ImageExpr
+ */
+
+#include <cstring>
+#include <cassert>
+#include <algorithm>
+
+#include <imageexpr.h>
+#include <imageperf.h>
+
+using namespace std;
+
+// Tamaño objetivo (en bytes) de cada banda de filas intermedia: cabe en la caché L2
+static const int BAND_BYTES = 256 * 1024;
+
+/********************************
+      FUNCIONES PRIVADAS
+********************************/
+
+ImageExpr::Stage & ImageExpr::Open(){
+    if (stages.empty() || stages.back().resample != NONE){
+        Stage stage;
+        stage.row = stage.col = 0;
+        stage.height = stage.width = -1;
+        for (int v = 0; v < 256; v++)
+            stage.table[v] = (byte)v;
+        stage.identity = true;
+        stage.resample = NONE;
+        stage.factor = 1;
+        stages.push_back(stage);
+    }
+    return stages.back();
+}
+
+void ImageExpr::Compose(const byte table[256]){
+    Stage & stage = Open();
+    for (int v = 0; v < 256; v++)
+        stage.table[v] = table[stage.table[v]];
+    stage.identity = false;
+}
+
+// Copia las filas [first, first+count) del recorte de la etapa a band, aplicando la tabla
+static void FillRows(const byte * const * src, int row, int col, int first, int count, int width,
+                     const byte table[256], bool identity, byte * const * band){
+    for (int k = 0; k < count; k++){
+        const byte * s = src[row + first + k] + col;
+        byte * d = band[k];
+        if (identity)
+            memcpy(d, s, width);
+        else
+            for (int j = 0; j < width; j++)
+                d[j] = table[s[j]];
+    }
+}
+
+Image ImageExpr::Evaluate(const Stage & stage, const Image & in){
+    int h = stage.height < 0 ? in.rows : stage.height;
+    int w = stage.width < 0 ? in.cols : stage.width;
+    if (h == 0 || w == 0)
+        return Image();
+
+    // Recorte + tabla: una sola pasada
+    if (stage.resample == NONE){
+        Image out(h, w);
+        FillRows(in.img, stage.row, stage.col, 0, h, w, stage.table, stage.identity, out.img);
+        return out;
+    }
+
+    // Subsample: bandas de un múltiplo de factor filas
+    if (stage.resample == SUBSAMPLE){
+        const int f = stage.factor;
+        Image out(h / f, w / f);
+        if (out.Empty())
+            return out;
+
+        int band_out = max(1, BAND_BYTES / (w * f));
+        Image band(band_out * f, w);
+        for (int i = 0; i < out.rows; i += band_out){
+            int n = min(band_out, out.rows - i);
+            if (n != band_out)
+                band = Image(n * f, w);
+            FillRows(in.img, stage.row, stage.col, i * f, n * f, w, stage.table, stage.identity, band.img);
+            Image part = band.Subsample(f);
+            for (int k = 0; k < n; k++)
+                memcpy(out.img[i + k], part.img[k], out.cols);
+        }
+        return out;
+    }
+
+    // Zoom2X: bandas que comparten su última fila con la siguiente
+    Image out(2*h - 1, 2*w - 1);
+    int band_rows = max(2, BAND_BYTES / (4 * w));
+    Image band(min(band_rows, h), w);
+    int a = 0, b;
+    do {
+        b = min(a + band_rows - 1, h - 1);
+        if (b - a + 1 != band.rows)
+            band = Image(b - a + 1, w);
+        FillRows(in.img, stage.row, stage.col, a, b - a + 1, w, stage.table, stage.identity, band.img);
+        Image part = band.Zoom2X();
+        for (int k = (a == 0 ? 0 : 1); k < part.rows; k++)
+            memcpy(out.img[2*a + k], part.img[k], out.cols);
+        a = b;
+    } while (b < h - 1);
+    return out;
+}
+
+/********************************
+       FUNCIONES PÚBLICAS
+********************************/
+
+ImageExpr Image::lazy() const{
+    return ImageExpr(*this);
+}
+
+ImageExpr::ImageExpr(const Image & img) : source(&img), out_rows(img.get_rows()), out_cols(img.get_cols()){
+}
+
+ImageExpr & ImageExpr::invert(){
+    byte table[256];
+    for (int v = 0; v < 256; v++)
+        table[v] = (byte)(255 - v);
+    Compose(table);
+    return *this;
+}
+
+ImageExpr & ImageExpr::contrast(byte in1, byte in2, byte out1, byte out2){
+    assert(in1 < in2 && out1 < out2);
+    byte table[256];
+    Image::ContrastTable(in1, in2, out1, out2, table);
+    Compose(table);
+    return *this;
+}
+
+ImageExpr & ImageExpr::crop(int nrow, int ncol, int height, int width){
+    assert(nrow >= 0 && ncol >= 0 && height >= 0 && width >= 0);
+    assert(nrow + height <= out_rows && ncol + width <= out_cols);
+
+    // Las operaciones puntuales conmutan con el recorte: se componen las ventanas
+    Stage & stage = Open();
+    stage.row += nrow;
+    stage.col += ncol;
+    stage.height = height;
+    stage.width = width;
+    out_rows = height;
+    out_cols = width;
+    return *this;
+}
+
+ImageExpr & ImageExpr::subsample(int factor){
+    assert(factor > 0);
+    Stage & stage = Open();
+    stage.resample = SUBSAMPLE;
+    stage.factor = factor;
+    out_rows /= factor;
+    out_cols /= factor;
+    if (out_rows == 0 || out_cols == 0)
+        out_rows = out_cols = 0;
+    return *this;
+}
+
+ImageExpr & ImageExpr::zoom2x(){
+    Stage & stage = Open();
+    stage.resample = ZOOM;
+    if (out_rows > 0 && out_cols > 0){
+        out_rows = 2*out_rows - 1;
+        out_cols = 2*out_cols - 1;
+    }
+    return *this;
+}
+
+Image ImageExpr::eval() const{
+    IMAGE_PERF_SCOPE("lazy");
+    Image result;
+    const Image * in = source;
+    for (size_t k = 0; k < stages.size(); k++){
+        result = Evaluate(stages[k], *in);
+        in = &result;
+    }
+    if (stages.empty())
+        result = *source;
+    return result;
+}
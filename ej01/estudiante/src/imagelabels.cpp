@@ -0,0 +1,290 @@
+/**
+ * @file imagelabels.cpp
+ * @brief Fichero con definiciones para los métodos de la clase ImageLabels
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <thread>
+#include <unordered_map>
+
+#include <imagelabels.h>
+#include <imageperf.h>
+
+using namespace std;
+
+// Las imágenes con menos píxeles se etiquetan en un solo hilo
+static const size_t LABEL_PARALLEL_PIXELS = 1 << 18;
+
+// Estadísticas en construcción de una componente
+struct ComponentAccum{
+    long area;
+    int first_row, first_col, last_row, last_col;
+    unsigned long long sum;
+};
+
+/********************************
+      UNIÓN-BÚSQUEDA
+********************************/
+
+// Las etiquetas provisionales forman un bosque en parent: parent[x] == x si x es
+// raíz, y si no parent[x] < x. La raíz de cada componente es su menor etiqueta.
+// Cada búsqueda acorta el camino a la mitad (parent[x] pasa a ser el abuelo de x).
+static int Find(int * parent, int x){
+    while (parent[x] != x){
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+    return x;
+}
+
+// Une las componentes de a y b y devuelve la raíz común
+static int Union(int * parent, int a, int b){
+    a = Find(parent, a);
+    b = Find(parent, b);
+    if (a < b)
+        parent[b] = a;
+    else
+        parent[a] = b;
+    return min(a, b);
+}
+
+/********************************
+      PASADAS POR BANDAS
+********************************/
+
+// Primera pasada sobre las filas [r0, r1): etiqueta provisional de cada píxel de
+// primer plano, mirando sólo los vecinos ya visitados de la banda. Las etiquetas
+// nuevas se toman a partir de next, que es exclusivo de la banda. Devuelve la
+// siguiente etiqueta libre.
+static int FirstPass(const byte * const * img, int cols, byte threshold, bool eight,
+                     int * labels, int * parent, int r0, int r1, int next){
+    for (int i = r0; i < r1; i++){
+        const byte * s = img[i];
+        int * l = labels + (size_t)i * cols;
+        const int * up = i > r0 ? l - cols : 0;
+
+        for (int j = 0; j < cols; j++){
+            if (s[j] < threshold){
+                l[j] = 0;
+                continue;
+            }
+            int left = j > 0 ? l[j-1] : 0;
+            int top = up ? up[j] : 0;
+
+            if (eight){
+                // Si el de arriba es de primer plano, los demás vecinos ya están en su componente
+                int top_left = up && j > 0 ? up[j-1] : 0;
+                int top_right = up && j + 1 < cols ? up[j+1] : 0;
+                if (top)
+                    l[j] = top;
+                else if (top_right){
+                    if (top_left)
+                        l[j] = Union(parent, top_right, top_left);
+                    else if (left)
+                        l[j] = Union(parent, top_right, left);
+                    else
+                        l[j] = top_right;
+                }
+                else if (top_left)
+                    l[j] = top_left;
+                else if (left)
+                    l[j] = left;
+                else{
+                    parent[next] = next;
+                    l[j] = next++;
+                }
+            }
+            else{
+                if (top && left)
+                    l[j] = Union(parent, top, left);
+                else if (top || left)
+                    l[j] = top ? top : left;
+                else{
+                    parent[next] = next;
+                    l[j] = next++;
+                }
+            }
+        }
+    }
+    return next;
+}
+
+// Une las componentes de la fila r con las de la fila anterior (borde entre bandas)
+static void MergeRows(int cols, bool eight, int * labels, int * parent, int r){
+    const int * l = labels + (size_t)r * cols;
+    const int * up = l - cols;
+    for (int j = 0; j < cols; j++){
+        if (l[j] == 0)
+            continue;
+        if (up[j])
+            Union(parent, l[j], up[j]);
+        else if (eight){
+            if (j > 0 && up[j-1])
+                Union(parent, l[j], up[j-1]);
+            if (j + 1 < cols && up[j+1])
+                Union(parent, l[j], up[j+1]);
+        }
+    }
+}
+
+// Segunda pasada sobre las filas [r0, r1): etiqueta definitiva de cada píxel y
+// estadísticas. Se recorren tramos de píxeles seguidos con la misma etiqueta
+// provisional, y el área y el rectángulo se actualizan una vez por tramo. Las
+// componentes cuya etiqueta está en [own_lo, own_hi) empiezan en esta banda y sólo
+// esta banda las escribe en acc; las demás vienen de bandas anteriores y se
+// acumulan aparte en foreign.
+static void SecondPass(const byte * const * img, int cols, const int * final_label, int * labels,
+                       int r0, int r1, int own_lo, int own_hi, ComponentAccum * acc,
+                       unordered_map<int, ComponentAccum> & foreign){
+    for (int i = r0; i < r1; i++){
+        const byte * s = img[i];
+        int * l = labels + (size_t)i * cols;
+        int j = 0;
+        while (j < cols){
+            int provisional = l[j];
+            if (provisional == 0){
+                j++;
+                continue;
+            }
+            int k = final_label[provisional];
+            int start = j;
+            unsigned sum = 0;
+            for (; j < cols && l[j] == provisional; j++){
+                l[j] = k;
+                sum += s[j];
+            }
+
+            ComponentAccum * a;
+            if (k >= own_lo && k < own_hi)
+                a = &acc[k];
+            else
+                a = &foreign[k];
+            if (a->area == 0){
+                a->first_row = i;
+                a->first_col = start;
+                a->last_col = j - 1;
+            }
+            a->area += j - start;
+            a->sum += sum;
+            a->last_row = i;
+            a->first_col = min(a->first_col, start);
+            a->last_col = max(a->last_col, j - 1);
+        }
+    }
+}
+
+/********************************
+       FUNCIONES PÚBLICAS
+********************************/
+
+ImageLabels::ImageLabels() : rows(0), cols(0){
+}
+
+ImageLabels::ImageLabels(const Image & image, byte threshold, int connectivity, int threads) : ImageLabels(){
+    Label(image, threshold, connectivity, threads);
+}
+
+// _____________________________________________________________________________
+
+void ImageLabels::Label(const Image & image, byte threshold, int connectivity, int threads){
+    IMAGE_PERF_SCOPE("Label");
+    assert((connectivity == 4 || connectivity == 8) && threads >= 1);
+    rows = image.rows;
+    cols = image.cols;
+    labels.assign((size_t)rows * cols, 0);
+    stats.clear();
+    if (image.Empty())
+        return;
+
+    const bool eight = connectivity == 8;
+    const byte * const * img = image.img;
+
+    int bands = 1;
+    if ((size_t)rows * cols >= LABEL_PARALLEL_PIXELS)
+        bands = min(threads, rows);
+
+    // Etiquetas provisionales de la banda b: desde first[b] (primer píxel de la
+    // banda + 1) hasta used[b], sin solaparse con las de otras bandas
+    vector<int> parent((size_t)rows * cols + 1);
+    vector<int> first(bands), used(bands), band_row(bands + 1);
+    for (int b = 0; b <= bands; b++)
+        band_row[b] = (long long)rows * b / bands;
+    for (int b = 0; b < bands; b++)
+        first[b] = band_row[b] * cols + 1;
+
+    {
+        vector<thread> workers;
+        for (int b = 1; b < bands; b++)
+            workers.push_back(thread([&, b]{
+                used[b] = FirstPass(img, cols, threshold, eight, labels.data(), parent.data(),
+                                    band_row[b], band_row[b+1], first[b]);
+            }));
+        used[0] = FirstPass(img, cols, threshold, eight, labels.data(), parent.data(),
+                            band_row[0], band_row[1], first[0]);
+        for (size_t b = 0; b < workers.size(); b++)
+            workers[b].join();
+    }
+
+    for (int b = 1; b < bands; b++)
+        MergeRows(cols, eight, labels.data(), parent.data(), band_row[b]);
+
+    // Etiquetas definitivas consecutivas. Como parent[x] < x salvo en las raíces,
+    // al recorrer las etiquetas en orden creciente la de parent[x] ya es definitiva.
+    // own[b] es la primera etiqueta definitiva de las componentes que empiezan en la banda b.
+    int n = 0;
+    vector<int> own(bands + 1);
+    for (int b = 0; b < bands; b++){
+        own[b] = n + 1;
+        for (int x = first[b]; x < used[b]; x++)
+            parent[x] = parent[x] == x ? ++n : parent[parent[x]];
+    }
+    own[bands] = n + 1;
+
+    vector<ComponentAccum> acc(n + 1, ComponentAccum{0, 0, 0, 0, 0, 0});
+    vector<unordered_map<int, ComponentAccum> > foreign(bands);
+    {
+        vector<thread> workers;
+        for (int b = 1; b < bands; b++)
+            workers.push_back(thread([&, b]{
+                SecondPass(img, cols, parent.data(), labels.data(), band_row[b], band_row[b+1],
+                           own[b], own[b+1], acc.data(), foreign[b]);
+            }));
+        SecondPass(img, cols, parent.data(), labels.data(), band_row[0], band_row[1],
+                   own[0], own[1], acc.data(), foreign[0]);
+        for (size_t b = 0; b < workers.size(); b++)
+            workers[b].join();
+    }
+
+    // Partes de componentes que vienen de bandas anteriores
+    for (int b = 1; b < bands; b++)
+        for (auto & part : foreign[b]){
+            ComponentAccum & a = acc[part.first];
+            const ComponentAccum & p = part.second;
+            a.area += p.area;
+            a.sum += p.sum;
+            a.last_row = max(a.last_row, p.last_row);
+            a.first_col = min(a.first_col, p.first_col);
+            a.last_col = max(a.last_col, p.last_col);
+        }
+
+    stats.resize(n);
+    for (int k = 1; k <= n; k++){
+        const ComponentAccum & a = acc[k];
+        ComponentStats & c = stats[k-1];
+        c.area = a.area;
+        c.row = a.first_row;
+        c.col = a.first_col;
+        c.height = a.last_row - a.first_row + 1;
+        c.width = a.last_col - a.first_col + 1;
+        c.mean = round((double)a.sum / a.area);
+    }
+}
+
+// _____________________________________________________________________________
+
+const ComponentStats & ImageLabels::component(int k) const {
+    assert(k >= 1 && k <= count());
+    return stats[k-1];
+}
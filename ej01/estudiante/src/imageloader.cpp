@@ -0,0 +1,111 @@
+/**
+ * @file imageloader.cpp
+ * @brief Fichero con definiciones para los métodos de la clase ImageLoader
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <imageloader.h>
+
+using namespace std;
+
+/********************************
+      FUNCIONES PRIVADAS
+********************************/
+
+void ImageLoader::Work(){
+    while (true){
+        LoadedImage item;
+        {
+            lock_guard<mutex> guard(lock);
+            if (stopping || next_path == paths.size())
+                return;
+            item.index = next_path++;
+        }
+
+        // La lectura se hace sin el cerrojo: los hilos leen en paralelo
+        item.path = paths[item.index];
+        item.result = item.image.LoadWithStatus(item.path.c_str());
+
+        unique_lock<mutex> guard(lock);
+        not_full.wait(guard, [this]{ return stopping || ready.size() < capacity; });
+        if (stopping)
+            return;
+        ready.push_back(move(item));
+        not_empty.notify_one();
+    }
+}
+
+/********************************
+       FUNCIONES PÚBLICAS
+********************************/
+
+ImageLoader::ImageLoader(const vector<string> & files, int io_threads, size_t queue_capacity)
+    : paths(files), capacity(queue_capacity), next_path(0), delivered(0), stopping(false){
+    assert(io_threads > 0 && queue_capacity > 0);
+    int n = min((size_t)io_threads, paths.size());
+    for (int k = 0; k < n; k++)
+        workers.push_back(thread(&ImageLoader::Work, this));
+}
+
+ImageLoader::~ImageLoader(){
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    not_full.notify_all();
+    not_empty.notify_all();
+    for (size_t k = 0; k < workers.size(); k++)
+        workers[k].join();
+}
+
+bool ImageLoader::Next(LoadedImage & item){
+    unique_lock<mutex> guard(lock);
+    // Cada archivo de la lista produce exactamente una entrada en la cola
+    not_empty.wait(guard, [this]{ return !ready.empty() || delivered == paths.size() || stopping; });
+    if (ready.empty())
+        return false;
+
+    item = move(ready.front());
+    ready.pop_front();
+    delivered++;
+    not_full.notify_one();
+    // Con la última imagen entregada, los demás consumidores tienen que terminar
+    if (delivered == paths.size())
+        not_empty.notify_all();
+    return true;
+}
+
+// _____________________________________________________________________________
+
+vector<string> ExpandImagePaths(const vector<string> & args){
+    vector<string> files;
+    for (size_t k = 0; k < args.size(); k++){
+        struct stat info;
+        if (stat(args[k].c_str(), &info) != 0 || !S_ISDIR(info.st_mode)){
+            files.push_back(args[k]);
+            continue;
+        }
+
+        vector<string> entries;
+        DIR * dir = opendir(args[k].c_str());
+        if (!dir)
+            continue;
+        for (struct dirent * entry = readdir(dir); entry != 0; entry = readdir(dir)){
+            string name = entry->d_name;
+            if (name.size() > 4 && (name.compare(name.size() - 4, 4, ".pgm") == 0 ||
+                                    name.compare(name.size() - 4, 4, ".pgb") == 0))
+                entries.push_back(args[k] + "/" + name);
+        }
+        closedir(dir);
+
+        sort(entries.begin(), entries.end());
+        files.insert(files.end(), entries.begin(), entries.end());
+    }
+    return files;
+}
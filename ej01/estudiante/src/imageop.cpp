@@ -4,16 +4,23 @@
  */
 
 #include <iostream>
+#include <algorithm>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
 #include <image.h>
+#include <imageperf.h>
 
 #include <cassert>
 void Image::Invert() {
+    IMAGE_PERF_SCOPE("Invert");
     for (int i=0; i<this->size(); i++)
         this->set_pixel(i,255-this->get_pixel(i));
 }
 
 Image Image::Crop(int nrow, int ncol, int height, int width) const {
+    IMAGE_PERF_SCOPE("Crop");
     Image exit_img(height, width, 0) ;
     for(int i = 0 ; i < height ; i++){
         for(int j = 0 ; j < width ; j++) {
@@ -23,45 +30,268 @@ Image Image::Crop(int nrow, int ncol, int height, int width) const {
     return exit_img ;
 }
 
-Image Image::Zoom2X() const {
-    Image zoomed_img(2*this->get_rows() - 1 , 2*this->get_cols() - 1 , 0 ) ;
-    for ( int i = 0 ; i < zoomed_img.get_rows() ; i++){
-        if(i%2==0) {
-            for (int j = 0; j < zoomed_img.get_cols(); j++) {
-                if (j % 2 == 0) {
-                    zoomed_img.set_pixel(i, j, this->get_pixel(i / 2, j / 2));
-                }
-                else {
-                    zoomed_img.set_pixel(i, j, (this->Mean(i/2,(j-1)/2,1,2)));//(this->get_pixel(i/2 , (j-1)/ 2))+(this->get_pixel(i/ 2, (j+1)/ 2))/2));
-                }
-            }
+/********************************
+   KERNELS ESPECIALIZADOS (SIMD)
+********************************/
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+
+// Cada kernel procesa 16 bytes de cada fila origen por iteración (16/factor
+// píxeles del icono) y devuelve la primera columna del icono que queda sin
+// procesar. El resto lo termina el bucle escalar de SubsampleInto.
+template <int factor>
+static int SubsampleBlocks(const byte * const *, byte *, int){
+    return 0;
+}
+
+// factor 2: pares horizontales con _mm_madd_epi16 (8 píxeles por iteración)
+template <>
+int SubsampleBlocks<2>(const byte * const * src, byte * dst, int out_cols){
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi16(1);
+    const __m128i half = _mm_set1_epi32(2);
+    int j = 0;
+    for (; j + 8 <= out_cols; j += 8){
+        __m128i lo = zero, hi = zero;
+        for (int a = 0; a < 2; a++){
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src[a] + 2*j));
+            lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi8(v, zero), ones));
+            hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi8(v, zero), ones));
         }
-        else{
-            for (int j = 0; j < zoomed_img.get_cols(); j++) {
-                if (j % 2 == 0) {
-                    zoomed_img.set_pixel(i, j, (this->Mean((i-1)/2,j/2,2,1)));//((this->get_pixel((i-1)/2 , j/ 2))+(this->get_pixel((i+1)/ 2, j/ 2))/2));
-                }
-                else {
-                    zoomed_img.set_pixel(i, j, (this->Mean((i-1)/2,(j-1)/2,2,2)));//((this->get_pixel((i-1)/2 , (j-1)/ 2))+(this->get_pixel((i+1)/ 2, (j+1)/ 2))+(this->get_pixel((i-1)/2 , (j+1)/ 2))+(this->get_pixel((i+1)/ 2, (j-1)/ 2))/4));
-                }
-            }
+        lo = _mm_srli_epi32(_mm_add_epi32(lo, half), 2);
+        hi = _mm_srli_epi32(_mm_add_epi32(hi, half), 2);
+        __m128i out = _mm_packus_epi16(_mm_packs_epi32(lo, hi), zero);
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(dst + j), out);
+    }
+    return j;
+}
+
+// factor 4: _mm_sad_epu8 sobre las mitades de cada palabra de 64 bits (4 píxeles por iteración)
+template <>
+int SubsampleBlocks<4>(const byte * const * src, byte * dst, int out_cols){
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i low32 = _mm_set_epi32(0, -1, 0, -1);
+    const __m128i half = _mm_set1_epi32(8);
+    int j = 0;
+    for (; j + 4 <= out_cols; j += 4){
+        __m128i even = zero, odd = zero;
+        for (int a = 0; a < 4; a++){
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src[a] + 4*j));
+            even = _mm_add_epi64(even, _mm_sad_epu8(_mm_and_si128(v, low32), zero));
+            odd = _mm_add_epi64(odd, _mm_sad_epu8(_mm_srli_epi64(v, 32), zero));
+        }
+        __m128i sums = _mm_or_si128(even, _mm_slli_epi64(odd, 32));
+        sums = _mm_srli_epi32(_mm_add_epi32(sums, half), 4);
+        __m128i out = _mm_packus_epi16(_mm_packs_epi32(sums, zero), zero);
+        int packed = _mm_cvtsi128_si32(out);
+        memcpy(dst + j, &packed, 4);
+    }
+    return j;
+}
+
+// factor 8: _mm_sad_epu8 suma directamente cada grupo de 8 bytes (2 píxeles por iteración)
+template <>
+int SubsampleBlocks<8>(const byte * const * src, byte * dst, int out_cols){
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i half = _mm_set_epi32(0, 32, 0, 32);
+    int j = 0;
+    for (; j + 2 <= out_cols; j += 2){
+        __m128i sums = zero;
+        for (int a = 0; a < 8; a++){
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src[a] + 8*j));
+            sums = _mm_add_epi64(sums, _mm_sad_epu8(v, zero));
+        }
+        sums = _mm_srli_epi64(_mm_add_epi64(sums, half), 6);
+        dst[j] = (byte)_mm_cvtsi128_si32(sums);
+        dst[j+1] = (byte)_mm_cvtsi128_si32(_mm_srli_si128(sums, 8));
+    }
+    return j;
+}
+
+// Fila par del zoom: píxeles originales intercalados con la media de cada par
+// horizontal. _mm_avg_epu8 calcula (a+b+1)>>1, que es el redondeo de Mean.
+static int ZoomEvenRowBlocks(const byte * s, byte * d, int cols){
+    int j = 0;
+    for (; j + 16 < cols; j += 16){
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + j));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + j + 1));
+        __m128i m = _mm_avg_epu8(a, b);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(d + 2*j), _mm_unpacklo_epi8(a, m));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(d + 2*j + 16), _mm_unpackhi_epi8(a, m));
+    }
+    return j;
+}
+
+// Fila impar del zoom: medias verticales intercaladas con medias de 2x2
+static int ZoomOddRowBlocks(const byte * s, const byte * t, byte * d, int cols){
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i two = _mm_set1_epi16(2);
+    int j = 0;
+    for (; j + 16 < cols; j += 16){
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + j));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + j + 1));
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(t + j));
+        __m128i e = _mm_loadu_si128(reinterpret_cast<const __m128i *>(t + j + 1));
+        __m128i vertical = _mm_avg_epu8(a, c);
+
+        __m128i lo = _mm_add_epi16(_mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero)),
+                                   _mm_add_epi16(_mm_unpacklo_epi8(c, zero), _mm_unpacklo_epi8(e, zero)));
+        __m128i hi = _mm_add_epi16(_mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero)),
+                                   _mm_add_epi16(_mm_unpackhi_epi8(c, zero), _mm_unpackhi_epi8(e, zero)));
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, two), 2);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, two), 2);
+        __m128i square = _mm_packus_epi16(lo, hi);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(d + 2*j), _mm_unpacklo_epi8(vertical, square));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(d + 2*j + 16), _mm_unpackhi_epi8(vertical, square));
+    }
+    return j;
+}
+
+// Compare: diferencia absoluta con restas saturadas, píxeles distintos con
+// _mm_cmpeq_epi8 y cuadrados con _mm_madd_epi16 (16 píxeles por iteración). Los
+// bloques sin diferencias no suman nada al error cuadrático. @a first es la
+// columna del primer píxel distinto, o -1.
+static int CompareBlocks(const byte * a, const byte * b, int n, long & mismatches,
+                         int & max_diff, unsigned long long & sse, int & first){
+    const __m128i zero = _mm_setzero_si128();
+    __m128i vmax = zero;
+    int j = 0;
+    first = -1;
+    while (j + 16 <= n){
+        // Cada carril de 32 bits suma como mucho 4*255^2 por iteración: se vuelca
+        // a 64 bits cada 4096 iteraciones, antes de que pueda desbordarse
+        const int stop = std::min(n - 15, j + 16 * 4096);
+        __m128i vsse = zero;
+        for (; j < stop; j += 16){
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + j));
+            __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + j));
+            unsigned diff = ~_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) & 0xffff;
+            if (diff == 0)
+                continue;
+
+            if (first < 0)
+                first = j + __builtin_ctz(diff);
+            mismatches += __builtin_popcount(diff);
+            __m128i d = _mm_or_si128(_mm_subs_epu8(x, y), _mm_subs_epu8(y, x));
+            vmax = _mm_max_epu8(vmax, d);
+            __m128i lo = _mm_unpacklo_epi8(d, zero), hi = _mm_unpackhi_epi8(d, zero);
+            vsse = _mm_add_epi32(vsse, _mm_add_epi32(_mm_madd_epi16(lo, lo), _mm_madd_epi16(hi, hi)));
+        }
+        unsigned lanes[4];
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), vsse);
+        sse += (unsigned long long)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    }
+
+    byte maxima[16];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(maxima), vmax);
+    for (int k = 0; k < 16; k++)
+        max_diff = std::max(max_diff, (int)maxima[k]);
+    return j;
+}
+#endif
+
+template <int factor>
+void Image::SubsampleInto(Image & icon, int first_row, int last_row) const {
+    const unsigned n = factor * factor;
+    const byte * src[factor];
+
+    if (last_row < 0)
+        last_row = icon.rows;
+    for (int i = first_row; i < last_row; i++){
+        for (int a = 0; a < factor; a++)
+            src[a] = img[i*factor + a];
+        byte * dst = icon.img[i];
+
+        int j = 0;
+#ifdef __SSE2__
+        j = SubsampleBlocks<factor>(src, dst, icon.cols);
+#endif
+        // Bucles de longitud constante: el compilador los desenrolla por completo
+        for (; j < icon.cols; j++){
+            unsigned sum = 0;
+            for (int a = 0; a < factor; a++)
+                for (int b = 0; b < factor; b++)
+                    sum += src[a][j*factor + b];
+            dst[j] = (byte)((sum + n/2) / n);
+        }
+    }
+}
+
+// ImagePyramid construye cada nivel por bandas de filas con el factor 2
+template void Image::SubsampleInto<2>(Image &, int, int) const;
+
+void Image::Zoom2XInto(Image & zoomed) const {
+    for (int i = 0; i < rows; i++){
+        const byte * s = img[i];
+        byte * d = zoomed.img[2*i];
+
+        int j = 0;
+#ifdef __SSE2__
+        j = ZoomEvenRowBlocks(s, d, cols);
+#endif
+        for (; j + 1 < cols; j++){
+            d[2*j] = s[j];
+            d[2*j+1] = (byte)((s[j] + s[j+1] + 1) >> 1);
+        }
+        d[2*j] = s[j];
+
+        if (i + 1 == rows)
+            break;
+
+        const byte * t = img[i+1];
+        d = zoomed.img[2*i+1];
+
+        j = 0;
+#ifdef __SSE2__
+        j = ZoomOddRowBlocks(s, t, d, cols);
+#endif
+        for (; j + 1 < cols; j++){
+            d[2*j] = (byte)((s[j] + t[j] + 1) >> 1);
+            d[2*j+1] = (byte)((s[j] + s[j+1] + t[j] + t[j+1] + 2) >> 2);
         }
+        d[2*j] = (byte)((s[j] + t[j] + 1) >> 1);
     }
+}
+
+/********************************
+      OPERACIONES PÚBLICAS
+********************************/
+
+Image Image::Zoom2X() const {
+    IMAGE_PERF_SCOPE("Zoom2X");
+    if (Empty())
+        return Image();
+
+    Image zoomed_img(2*this->get_rows() - 1 , 2*this->get_cols() - 1) ;
+    Zoom2XInto(zoomed_img);
     return zoomed_img ;
 }
 
 Image Image::Subsample(int factor) const {
+    IMAGE_PERF_SCOPE("Subsample");
     assert(factor > 0) ;
     Image icon(this->get_rows()/factor, this->get_cols()/factor , 0);
-    for(int i = 0 ; i < icon.get_rows(); i++){
-        for(int j = 0 ; j < icon.get_cols() ; j++){
-            icon.set_pixel(i,j, this->Mean(i*factor,j*factor,factor,factor)) ;
-        }
+
+    // Los factores habituales usan kernels con el factor como constante
+    switch (factor){
+        case 1: SubsampleInto<1>(icon); break;
+        case 2: SubsampleInto<2>(icon); break;
+        case 4: SubsampleInto<4>(icon); break;
+        case 8: SubsampleInto<8>(icon); break;
+        default:
+            for(int i = 0 ; i < icon.get_rows(); i++){
+                for(int j = 0 ; j < icon.get_cols() ; j++){
+                    icon.set_pixel(i,j, this->Mean(i*factor,j*factor,factor,factor)) ;
+                }
+            }
     }
     return icon ;
 }
 
 double Image::Mean(int i, int j, int height, int width) const {
+    IMAGE_PERF_SCOPE("Mean");
     double sum = 0 ;
     for (int a = 0 ; a < height ; a++){
         for (int b = 0 ; b < width ; b++){
@@ -72,23 +302,16 @@ double Image::Mean(int i, int j, int height, int width) const {
     return mean ;
 }
 
-void Image::AdjustContrast(byte in1, byte in2, byte out1, byte out2) {
-
-    assert(in1 < in2 && out1 < out2);
-    assert(0 <= in1 && in1 <= 255);
-    assert(0 <= in2 && in2 <= 255);
-    assert(0 <= out1 && out1 <= 255);
-    assert(0 <= out2 && out2 <= 255);
+void Image::ContrastTable(byte in1, byte in2, byte out1, byte out2, byte table[256]) {
 
     // Pendientes del ajuste
     double k1 = (double)out1 / in1;
     double k2 = ((double)out2 - out1) / (in2 - in1);
     double k3 = ((double)255 - out2) / (255 - in2);
 
-    for(int i=0; i<this->size(); i++){
+    for(int old_pixel=0; old_pixel<256; old_pixel++){
 
         byte new_pixel;
-        byte old_pixel = this->get_pixel(i);
 
         if (old_pixel < in1)
             new_pixel = round(k1*old_pixel);
@@ -101,11 +324,35 @@ void Image::AdjustContrast(byte in1, byte in2, byte out1, byte out2) {
         else
             new_pixel = round(out2 + k3 * (old_pixel - in2));
 
-        this->set_pixel(i, new_pixel);
+        table[old_pixel] = new_pixel;
     }
 }
 
+void Image::ApplyTable(const byte table[256]) {
+    for (int i=0; i<rows; i++){
+        byte * row = img[i];
+        for (int j=0; j<cols; j++)
+            row[j] = table[row[j]];
+    }
+}
+
+void Image::AdjustContrast(byte in1, byte in2, byte out1, byte out2) {
+    IMAGE_PERF_SCOPE("AdjustContrast");
+
+    assert(in1 < in2 && out1 < out2);
+    assert(0 <= in1 && in1 <= 255);
+    assert(0 <= in2 && in2 <= 255);
+    assert(0 <= out1 && out1 <= 255);
+    assert(0 <= out2 && out2 <= 255);
+
+    // Sólo hay 256 valores posibles: se calcula cada uno una vez
+    byte table[256];
+    ContrastTable(in1, in2, out1, out2, table);
+    ApplyTable(table);
+}
+
 void Image::ShuffleRows() {
+    IMAGE_PERF_SCOPE("ShuffleRows");
 
     const int p = 9973;
     Image temp(rows,cols);
@@ -116,9 +363,53 @@ void Image::ShuffleRows() {
         newr = r*p % rows;
 
         // Reordenar las filas
-        temp.img[r] = this->img[newr];
+        memcpy(temp.img[r], this->img[newr], cols);
+
+    }
+
+    // Intercambiamos las representaciones: temp libera la antigua
+    std::swap(img, temp.img);
+}
 
+ImageDiff Image::Compare(const Image & other) const {
+    IMAGE_PERF_SCOPE("Compare");
+    ImageDiff d;
+    d.same_size = rows == other.rows && cols == other.cols;
+    d.mismatches = 0;
+    d.max_diff = 0;
+    d.sse = 0;
+    d.psnr = d.same_size ? INFINITY : 0;
+    d.first_row = d.first_col = -1;
+    if (!d.same_size)
+        return d;
+
+    for (int i = 0; i < rows; i++){
+        const byte * a = img[i];
+        const byte * b = other.img[i];
+        int first = -1;
+
+        int j = 0;
+#ifdef __SSE2__
+        j = CompareBlocks(a, b, cols, d.mismatches, d.max_diff, d.sse, first);
+#endif
+        for (; j < cols; j++){
+            int diff = std::abs(a[j] - b[j]);
+            if (diff == 0)
+                continue;
+            if (first < 0)
+                first = j;
+            d.mismatches++;
+            d.max_diff = std::max(d.max_diff, diff);
+            d.sse += diff * diff;
+        }
+
+        if (first >= 0 && d.first_row < 0){
+            d.first_row = i;
+            d.first_col = first;
+        }
     }
 
-    Copy(temp);
+    if (d.sse > 0)
+        d.psnr = 10 * log10(255.0 * 255.0 * ((double)rows * cols) / d.sse);
+    return d;
 }
\ No newline at end of file
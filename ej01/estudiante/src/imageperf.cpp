@@ -0,0 +1,247 @@
+/**
+  * @file imageperf.cpp
+  * @brief Fichero con definiciones para la instrumentación de rendimiento de la clase Image
+  *
+  * Los contadores se abren una vez por hilo como un grupo de perf_event_open
+  * (líder: ciclos) y se leen con una única llamada read() al inicio y al final
+  * de cada operación. Si no se pueden abrir, sólo se acumula el tiempo.
+  *
+  */
+
+#include <imageperf.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// Contadores del grupo, en este orden
+enum PerfCounter {PERF_CYCLES, PERF_INSTRUCTIONS, PERF_LLC_MISSES, PERF_BRANCH_MISSES, PERF_NUM_COUNTERS};
+
+static const char * counter_names[PERF_NUM_COUNTERS] = {"cycles", "instructions", "llc-misses", "branch-misses"};
+
+// _____________________________________________________________________________
+
+// Acumulado de una operación
+struct PerfStats{
+    unsigned long long calls = 0;
+    long long total_ns = 0;
+    unsigned long long counter_calls = 0;               // llamadas con contadores válidos
+    unsigned long long counters[PERF_NUM_COUNTERS] = {0, 0, 0, 0};
+    bool valid[PERF_NUM_COUNTERS] = {false, false, false, false};
+};
+
+static void WriteReport(ostream & os, const map<string, PerfStats> & ops);
+
+// Informe global, compartido por todos los hilos
+struct PerfRegistry{
+    mutex lock;
+    map<string, PerfStats> ops;
+
+    // Si se define la variable de entorno IMAGE_PERF_REPORT, el informe se
+    // muestra por la salida de error al terminar el programa
+    ~PerfRegistry(){
+        if (getenv("IMAGE_PERF_REPORT") && !ops.empty())
+            WriteReport(cerr, ops);
+    }
+};
+
+static PerfRegistry & Registry(){
+    static PerfRegistry registry;
+    return registry;
+}
+
+// _____________________________________________________________________________
+
+// Grupo de contadores de un hilo
+struct PerfGroup{
+    int leader = -1;
+    int fds[PERF_NUM_COUNTERS] = {-1, -1, -1, -1};
+    int slot[PERF_NUM_COUNTERS] = {-1, -1, -1, -1};    // posición en la lectura del grupo
+    int nr = 0;                                         // número de contadores abiertos
+    bool tried = false;
+
+    ~PerfGroup(){
+#ifdef __linux__
+        for (int k = 0; k < PERF_NUM_COUNTERS; k++)
+            if (fds[k] >= 0)
+                close(fds[k]);
+#endif
+    }
+
+    void Open(){
+        tried = true;
+#ifdef __linux__
+        const unsigned long long configs[PERF_NUM_COUNTERS] = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+        };
+
+        for (int k = 0; k < PERF_NUM_COUNTERS; k++){
+            struct perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[k];
+            attr.read_format = PERF_FORMAT_GROUP;
+            attr.disabled = (k == PERF_CYCLES);
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+
+            int fd = syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+            if (fd < 0){
+                if (k == PERF_CYCLES)
+                    return;             // sin líder no hay grupo: sólo tiempo
+                continue;               // este contador no existe en la máquina
+            }
+            if (k == PERF_CYCLES)
+                leader = fd;
+            fds[k] = fd;
+            slot[k] = nr++;
+        }
+        ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    // Lee todos los contadores del grupo. Devuelve false si no hay grupo.
+    bool Read(unsigned long long values[PERF_NUM_COUNTERS]){
+        if (!tried)
+            Open();
+        if (leader < 0)
+            return false;
+#ifdef __linux__
+        unsigned long long buffer[1 + PERF_NUM_COUNTERS];
+        ssize_t expected = (ssize_t)((1 + nr) * sizeof(unsigned long long));
+        if (read(leader, buffer, sizeof(buffer)) < expected)
+            return false;
+        for (int k = 0; k < PERF_NUM_COUNTERS; k++)
+            values[k] = slot[k] >= 0 ? buffer[1 + slot[k]] : 0;
+        return true;
+#else
+        (void)values;
+        return false;
+#endif
+    }
+};
+
+static thread_local PerfGroup group;
+static thread_local int depth = 0;
+
+static long long NowNs(){
+    return chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// _____________________________________________________________________________
+
+PerfScope::PerfScope(const char * op_name) : name(op_name), active(depth++ == 0), start_ns(0), counters(false){
+    if (!active)
+        return;
+    counters = group.Read(start);
+    start_ns = NowNs();
+}
+
+PerfScope::~PerfScope(){
+    depth--;
+    if (!active)
+        return;
+
+    long long elapsed = NowNs() - start_ns;
+    unsigned long long end[PERF_NUM_COUNTERS];
+    bool have = counters && group.Read(end);
+
+    PerfRegistry & registry = Registry();
+    lock_guard<mutex> guard(registry.lock);
+    PerfStats & stats = registry.ops[name];
+    stats.calls++;
+    stats.total_ns += elapsed;
+    if (have){
+        stats.counter_calls++;
+        for (int k = 0; k < PERF_NUM_COUNTERS; k++)
+            if (group.slot[k] >= 0){
+                stats.counters[k] += end[k] - start[k];
+                stats.valid[k] = true;
+            }
+    }
+}
+
+// _____________________________________________________________________________
+
+bool PerfEnabled(){
+#ifdef IMAGE_PERF_COUNTERS
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool PerfCountersAvailable(){
+    unsigned long long values[PERF_NUM_COUNTERS];
+    return group.Read(values);
+}
+
+// _____________________________________________________________________________
+
+static void WriteReport(ostream & os, const map<string, PerfStats> & ops){
+    ios::fmtflags flags = os.flags();
+    streamsize precision = os.precision();
+
+    os << left << setw(16) << "op" << right << setw(10) << "calls" << setw(14) << "total_ms"
+       << setw(14) << "mean_us";
+    for (int k = 0; k < PERF_NUM_COUNTERS; k++)
+        os << setw(16) << counter_names[k];
+    os << setw(8) << "IPC" << endl;
+
+    os << fixed;
+    for (map<string, PerfStats>::const_iterator it = ops.begin(); it != ops.end(); ++it){
+        const PerfStats & s = it->second;
+        os << left << setw(16) << it->first << right << setw(10) << s.calls
+           << setprecision(3) << setw(14) << s.total_ns / 1e6
+           << setw(14) << (s.calls ? s.total_ns / 1e3 / s.calls : 0.0);
+
+        // Contadores por llamada
+        os << setprecision(1);
+        for (int k = 0; k < PERF_NUM_COUNTERS; k++){
+            if (s.valid[k] && s.counter_calls)
+                os << setw(16) << (double)s.counters[k] / s.counter_calls;
+            else
+                os << setw(16) << "n/a";
+        }
+        if (s.valid[PERF_CYCLES] && s.valid[PERF_INSTRUCTIONS] && s.counters[PERF_CYCLES])
+            os << setprecision(2) << setw(8) << (double)s.counters[PERF_INSTRUCTIONS] / s.counters[PERF_CYCLES];
+        else
+            os << setw(8) << "n/a";
+        os << endl;
+    }
+
+    os.flags(flags);
+    os.precision(precision);
+}
+
+void PerfReport(ostream & os){
+    PerfRegistry & registry = Registry();
+    lock_guard<mutex> guard(registry.lock);
+    WriteReport(os, registry.ops);
+}
+
+void PerfReset(){
+    PerfRegistry & registry = Registry();
+    lock_guard<mutex> guard(registry.lock);
+    registry.ops.clear();
+}
+
+/* Fin Fichero: imageperf.cpp */
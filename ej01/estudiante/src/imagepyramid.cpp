@@ -0,0 +1,241 @@
+/**
+ * @file imagepyramid.cpp
+ * @brief Fichero con definiciones para los métodos de la clase ImagePyramid
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <stdint.h>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <imagepyramid.h>
+#include <imageperf.h>
+
+using namespace std;
+
+static const unsigned char PYRAMID_MAGIC[4] = {'P', 'Y', 'R', '1'};
+static const size_t PYRAMID_HEADER_SIZE = 8;
+static const size_t PYRAMID_ENTRY_SIZE = 16;
+static const int PYRAMID_MAX_LEVELS = 32;
+
+// Los niveles con menos píxeles se calculan en un solo hilo
+static const size_t PYRAMID_PARALLEL_PIXELS = 1 << 18;
+
+static void PutU32 (unsigned char *p, uint32_t v){
+    for (int k = 0; k < 4; k++)
+        p[k] = v >> (8*k);
+}
+
+static uint32_t GetU32 (const unsigned char *p){
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Entrada de la tabla de niveles
+struct PyramidEntry{
+    uint64_t offset;
+    int rows, cols;
+};
+
+// Lee n bytes en la posición offset. Devuelve SUCCESS, TRUNCATED o READING_ERROR.
+static LoadResult ReadAt (int fd, unsigned char *buf, size_t n, uint64_t offset){
+    size_t total = 0;
+    while (total < n){
+        ssize_t r = pread(fd, buf + total, n - total, offset + total);
+        if (r < 0 && errno == EINTR)
+            continue;
+        if (r < 0)
+            return READING_ERROR;
+        if (r == 0)
+            return TRUNCATED;
+        total += r;
+    }
+    return SUCCESS;
+}
+
+// Lee y comprueba la tabla de niveles
+static LoadResult ReadTable (int fd, vector<PyramidEntry> & table){
+    struct stat info;
+    if (fstat(fd, &info) != 0)
+        return READING_ERROR;
+
+    unsigned char head[PYRAMID_HEADER_SIZE];
+    LoadResult res = ReadAt(fd, head, sizeof(head), 0);
+    if (res != SUCCESS)
+        return res;
+    if (memcmp(head, PYRAMID_MAGIC, sizeof(PYRAMID_MAGIC)) != 0)
+        return NOT_PGM;
+    uint32_t n = GetU32(head + 4);
+    if (n == 0 || n > (uint32_t)PYRAMID_MAX_LEVELS)
+        return BAD_HEADER;
+
+    vector<unsigned char> raw(n * PYRAMID_ENTRY_SIZE);
+    res = ReadAt(fd, raw.data(), raw.size(), PYRAMID_HEADER_SIZE);
+    if (res != SUCCESS)
+        return res;
+
+    table.resize(n);
+    for (uint32_t k = 0; k < n; k++){
+        const unsigned char * e = &raw[k * PYRAMID_ENTRY_SIZE];
+        uint32_t rows = GetU32(e + 8), cols = GetU32(e + 12);
+        // Cada nivel tiene la mitad de filas y columnas que el anterior, y al
+        // menos una de cada (Build no guarda niveles vacíos)
+        if (rows == 0 || cols == 0)
+            return BAD_HEADER;
+        if (k == 0 ? (rows > 1u << 30 || cols > 1u << 30)
+                   : (rows != (uint32_t)table[k-1].rows / 2 || cols != (uint32_t)table[k-1].cols / 2))
+            return BAD_HEADER;
+        table[k].offset = GetU32(e) | ((uint64_t)GetU32(e + 4) << 32);
+        table[k].rows = rows;
+        table[k].cols = cols;
+        uint64_t bytes = (uint64_t)rows * cols;
+        if (table[k].offset > (uint64_t)info.st_size || bytes > (uint64_t)info.st_size - table[k].offset)
+            return TRUNCATED;
+    }
+    return SUCCESS;
+}
+
+/********************************
+       FUNCIONES PÚBLICAS
+********************************/
+
+ImagePyramid::ImagePyramid(){
+}
+
+ImagePyramid::ImagePyramid(const Image & base, int min_side, int threads){
+    Build(base, min_side, threads);
+}
+
+// _____________________________________________________________________________
+
+void ImagePyramid::Build(const Image & base, int min_side, int threads){
+    IMAGE_PERF_SCOPE("PyramidBuild");
+    assert(min_side >= 1 && threads >= 1);
+    levels.clear();
+    if (base.Empty())
+        return;
+
+    // Con la capacidad reservada, los niveles no se mueven al añadir otros
+    levels.reserve(PYRAMID_MAX_LEVELS);
+    levels.push_back(base);
+    while (levels.back().get_rows() / 2 >= min_side && levels.back().get_cols() / 2 >= min_side){
+        const Image & prev = levels.back();
+        Image next(prev.get_rows() / 2, prev.get_cols() / 2);
+
+        // Bandas de filas del nuevo nivel, una por hilo
+        int bands = 1;
+        if ((size_t)next.get_rows() * next.get_cols() >= PYRAMID_PARALLEL_PIXELS)
+            bands = min(threads, next.get_rows());
+        vector<thread> workers;
+        for (int b = 1; b < bands; b++)
+            workers.push_back(thread([&prev, &next, b, bands]{
+                prev.SubsampleInto<2>(next, next.get_rows() * b / bands, next.get_rows() * (b+1) / bands);
+            }));
+        prev.SubsampleInto<2>(next, 0, next.get_rows() / bands);
+        for (size_t b = 0; b < workers.size(); b++)
+            workers[b].join();
+
+        levels.push_back(move(next));
+    }
+}
+
+// _____________________________________________________________________________
+
+const Image & ImagePyramid::level(int k) const {
+    assert(k >= 0 && k < size());
+    return levels[k];
+}
+
+// _____________________________________________________________________________
+
+int ImagePyramid::LevelFor(int region_rows, int region_cols, int view_rows, int view_cols) const {
+    assert(size() > 0 && view_rows > 0 && view_cols > 0);
+    unsigned ratio = max(0, min(region_rows / view_rows, region_cols / view_cols));
+    if (ratio == 0)
+        return 0;
+    // Índice del bit más significativo: floor(log2(ratio))
+    int k = 31 - __builtin_clz(ratio);
+    return min(k, size() - 1);
+}
+
+// _____________________________________________________________________________
+
+bool ImagePyramid::Save(const char * file_path) const {
+    IMAGE_PERF_SCOPE("PyramidSave");
+    if (levels.empty())
+        return false;
+
+    vector<unsigned char> header(PYRAMID_HEADER_SIZE + levels.size() * PYRAMID_ENTRY_SIZE);
+    memcpy(header.data(), PYRAMID_MAGIC, sizeof(PYRAMID_MAGIC));
+    PutU32(&header[4], levels.size());
+    uint64_t offset = header.size();
+    for (size_t k = 0; k < levels.size(); k++){
+        unsigned char * e = &header[PYRAMID_HEADER_SIZE + k * PYRAMID_ENTRY_SIZE];
+        PutU32(e, offset);
+        PutU32(e + 4, offset >> 32);
+        PutU32(e + 8, levels[k].get_rows());
+        PutU32(e + 12, levels[k].get_cols());
+        offset += (uint64_t)levels[k].get_rows() * levels[k].get_cols();
+    }
+
+    ofstream f(file_path, ios::binary);
+    if (!f)
+        return false;
+    f.write(reinterpret_cast<const char *>(header.data()), header.size());
+    for (size_t k = 0; k < levels.size(); k++)
+        for (int i = 0; i < levels[k].get_rows(); i++)
+            f.write(reinterpret_cast<const char *>(levels[k].img[i]), levels[k].get_cols());
+    return (bool)f;
+}
+
+// _____________________________________________________________________________
+
+LoadResult ImagePyramid::Load(const char * file_path){
+    IMAGE_PERF_SCOPE("PyramidLoad");
+    levels.clear();
+
+    int fd = open(file_path, O_RDONLY);
+    if (fd < 0)
+        return OPEN_ERROR;
+
+    vector<PyramidEntry> table;
+    LoadResult res = ReadTable(fd, table);
+    levels.reserve(table.size());
+    for (size_t k = 0; k < table.size() && res == SUCCESS; k++){
+        // Las imágenes recién creadas tienen sus filas consecutivas
+        levels.push_back(Image(table[k].rows, table[k].cols));
+        res = ReadAt(fd, levels.back().img[0], (size_t)table[k].rows * table[k].cols, table[k].offset);
+    }
+    close(fd);
+
+    if (res != SUCCESS)
+        levels.clear();
+    return res;
+}
+
+// _____________________________________________________________________________
+
+LoadResult ImagePyramid::LoadLevel(const char * file_path, int k, Image & image){
+    int fd = open(file_path, O_RDONLY);
+    if (fd < 0)
+        return OPEN_ERROR;
+
+    vector<PyramidEntry> table;
+    LoadResult res = ReadTable(fd, table);
+    if (res == SUCCESS && (k < 0 || k >= (int)table.size()))
+        res = BAD_REGION;
+    if (res == SUCCESS){
+        Image level(table[k].rows, table[k].cols);
+        res = ReadAt(fd, level.img[0], (size_t)table[k].rows * table[k].cols, table[k].offset);
+        if (res == SUCCESS)
+            image = move(level);
+    }
+    close(fd);
+    return res;
+}
@@ -0,0 +1,85 @@
+/**
+ * @file imageswap.cpp
+ * @brief Fichero con definiciones para los métodos de la clase ImageSwap
+ *
+ * Todas las operaciones atómicas usan el orden secuencial (el de por defecto). El
+ * lector incrementa su contador y después comprueba que la imagen sigue publicada;
+ * el escritor publica otra imagen y después comprueba los contadores de la
+ * anterior. Con un orden total, o el lector ve que la imagen ya no está publicada
+ * y lo vuelve a intentar, o el escritor ve su contador y espera.
+ */
+
+#include <thread>
+
+#include <imageswap.h>
+
+using namespace std;
+
+/********************************
+       FUNCIONES PÚBLICAS
+********************************/
+
+ImageSwap::Frame::Frame(Frame && orig) noexcept : owner(orig.owner), slot(orig.slot){
+    orig.owner = 0;
+}
+
+ImageSwap::Frame::~Frame(){
+    if (owner != 0)
+        owner->readers[slot]--;
+}
+
+// _____________________________________________________________________________
+
+ImageSwap::ImageSwap() : front(0), last(0){
+    generations[0] = generations[1] = 0;
+    readers[0] = readers[1] = 0;
+}
+
+ImageSwap::ImageSwap(const Image & first) : ImageSwap(){
+    buffers[0] = first;
+}
+
+// _____________________________________________________________________________
+
+ImageSwap::Frame ImageSwap::Read(){
+    int k = front;
+    while (true){
+        readers[k]++;
+        int now = front;
+        if (now == k)
+            return Frame(this, k);
+        // Se publicó otra imagen entre la lectura de front y el incremento
+        readers[k]--;
+        k = now;
+    }
+}
+
+// _____________________________________________________________________________
+
+unsigned long ImageSwap::generation() const {
+    return last;
+}
+
+// _____________________________________________________________________________
+
+Image & ImageSwap::Back(){
+    int k = 1 - front;
+    while (readers[k] != 0)
+        this_thread::yield();
+    return buffers[k];
+}
+
+// _____________________________________________________________________________
+
+Image * ImageSwap::TryBack(){
+    int k = 1 - front;
+    return readers[k] == 0 ? &buffers[k] : 0;
+}
+
+// _____________________________________________________________________________
+
+void ImageSwap::Publish(){
+    int k = 1 - front;
+    generations[k] = ++last;
+    front = k;
+}
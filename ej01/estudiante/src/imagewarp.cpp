@@ -0,0 +1,299 @@
+/**
+ * @file imagewarp.cpp
+ * @brief Fichero con definiciones para AffineTransform y el método Warp de la clase Image
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+#include <image.h>
+#include <imageperf.h>
+
+using namespace std;
+
+// Coordenadas en coma fija con 16 bits de fracción
+static const int WARP_SHIFT = 16;
+static const long long WARP_ONE = 1LL << WARP_SHIFT;
+static const long long WARP_HALF = WARP_ONE / 2;
+
+// Pesos de la interpolación bilineal con 7 bits: caben en 16 bits con signo
+// multiplicados por un píxel (255*128), como necesita _mm_madd_epi16
+static const int WEIGHT_BITS = 7;
+static const int WEIGHT_ONE = 1 << WEIGHT_BITS;
+
+// Las imágenes resultado con menos píxeles se calculan en un solo hilo
+static const size_t WARP_PARALLEL_PIXELS = 1 << 18;
+
+/********************************
+      AffineTransform
+********************************/
+
+AffineTransform AffineTransform::Identity(){
+    return Scale(1, 1);
+}
+
+AffineTransform AffineTransform::Translation(double rows, double cols){
+    AffineTransform t = {{1, 0, rows, 0, 1, cols}};
+    return t;
+}
+
+AffineTransform AffineTransform::Scale(double row_factor, double col_factor){
+    AffineTransform t = {{row_factor, 0, 0, 0, col_factor, 0}};
+    return t;
+}
+
+AffineTransform AffineTransform::Rotation(double degrees, double center_row, double center_col){
+    // Las filas crecen hacia abajo: el giro antihorario en pantalla es
+    // r' = cos*r - sin*c, c' = sin*r + cos*c respecto del centro
+    double a = degrees * M_PI / 180;
+    double cs = cos(a), sn = sin(a);
+    AffineTransform t = {{cs, -sn, center_row - cs*center_row + sn*center_col,
+                          sn,  cs, center_col - sn*center_row - cs*center_col}};
+    return t;
+}
+
+AffineTransform AffineTransform::Shear(double row_per_col, double col_per_row){
+    AffineTransform t = {{1, row_per_col, 0, col_per_row, 1, 0}};
+    return t;
+}
+
+// _____________________________________________________________________________
+
+AffineTransform AffineTransform::Then(const AffineTransform & next) const {
+    const double * a = m;
+    const double * b = next.m;
+    AffineTransform t = {{b[0]*a[0] + b[1]*a[3], b[0]*a[1] + b[1]*a[4], b[0]*a[2] + b[1]*a[5] + b[2],
+                          b[3]*a[0] + b[4]*a[3], b[3]*a[1] + b[4]*a[4], b[3]*a[2] + b[4]*a[5] + b[5]}};
+    return t;
+}
+
+// _____________________________________________________________________________
+
+bool AffineTransform::Inverse(AffineTransform & inverse) const {
+    double det = m[0]*m[4] - m[1]*m[3];
+    if (fabs(det) < 1e-12)
+        return false;
+
+    double i0 = m[4] / det, i1 = -m[1] / det, i3 = -m[3] / det, i4 = m[0] / det;
+    AffineTransform t = {{i0, i1, -(i0*m[2] + i1*m[5]), i3, i4, -(i3*m[2] + i4*m[5])}};
+    inverse = t;
+    return true;
+}
+
+/********************************
+   KERNELS DE WARP
+********************************/
+
+// División entera redondeando hacia -infinito y hacia +infinito, con b > 0
+static long long FloorDiv(long long a, long long b){
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+static long long CeilDiv(long long a, long long b){
+    return -FloorDiv(-a, b);
+}
+
+// Restringe [j0, j1) a las columnas j con lo <= start + j*step <= hi. La
+// coordenada de cada columna es exacta en coma fija, así que el intervalo
+// también: no hace falta comprobar cada píxel.
+static void ClipSpan(long long start, long long step, long long lo, long long hi, long long & j0, long long & j1){
+    if (step == 0){
+        if (start < lo || start > hi)
+            j1 = j0;
+        return;
+    }
+    if (step > 0){
+        j0 = max(j0, CeilDiv(lo - start, step));
+        j1 = min(j1, FloorDiv(hi - start, step) + 1);
+    }
+    else{
+        j0 = max(j0, CeilDiv(start - hi, -step));
+        j1 = min(j1, FloorDiv(start - lo, -step) + 1);
+    }
+}
+
+// Interpolación bilineal en (r, c), en coma fija. En la última fila o columna el
+// vecino siguiente es el propio píxel, que de todas formas tiene peso 0. Con
+// pesos de 1/2 el redondeo coincide con el de Mean(): (a+b+1)>>1 y (a+b+c+d+2)>>2.
+static inline byte Bilinear(const byte * const * src, int rows, int cols, long long r, long long c){
+    int i = r >> WARP_SHIFT, j = c >> WARP_SHIFT;
+    int fr = (r >> (WARP_SHIFT - WEIGHT_BITS)) & (WEIGHT_ONE - 1);
+    int fc = (c >> (WARP_SHIFT - WEIGHT_BITS)) & (WEIGHT_ONE - 1);
+    const byte * s = src[i];
+    const byte * t = src[i + (i + 1 < rows)];
+    int j1 = j + (j + 1 < cols);
+    int top = s[j] * (WEIGHT_ONE - fc) + s[j1] * fc;
+    int bottom = t[j] * (WEIGHT_ONE - fc) + t[j1] * fc;
+    return (byte)((top * (WEIGHT_ONE - fr) + bottom * fr + (1 << (2*WEIGHT_BITS - 1))) >> (2*WEIGHT_BITS));
+}
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+
+// Interpolación bilineal de 4 píxeles por iteración, con el mismo resultado que
+// Bilinear. SSE2 no tiene instrucción gather: cada par de vecinos (izquierdo,
+// derecho) se lee con una sola carga de 16 bits, y los 4 pares de cada fila se
+// ensanchan a 16 bits por píxel para que _mm_madd_epi16 haga cada interpolación
+// horizontal en una instrucción; la vertical se hace igual con los pares
+// (superior, inferior). Devuelve los píxeles calculados (múltiplo de 4).
+// @pre Las coordenadas de los n píxeles tienen vecino siguiente en fila y
+// columna dentro de la imagen, y caben en 32 bits.
+static int WarpBilinearBlocks(const byte * const * src, long long r, long long c,
+                              long long dr, long long dc, byte * d, int n){
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi32(WEIGHT_ONE);
+    const __m128i fraction = _mm_set1_epi32(WEIGHT_ONE - 1);
+    const __m128i half = _mm_set1_epi32(1 << (2*WEIGHT_BITS - 1));
+    const __m128i step_r = _mm_set1_epi32((int)(4*dr));
+    const __m128i step_c = _mm_set1_epi32((int)(4*dc));
+    __m128i vr = _mm_set_epi32((int)(r + 3*dr), (int)(r + 2*dr), (int)(r + dr), (int)r);
+    __m128i vc = _mm_set_epi32((int)(c + 3*dc), (int)(c + 2*dc), (int)(c + dc), (int)c);
+
+    // Aritmética sin signo: tras el último píxel la coordenada puede salirse de 32 bits
+    unsigned ri = (unsigned)r, ci = (unsigned)c;
+    const unsigned step_ri = (unsigned)dr, step_ci = (unsigned)dc;
+    int j = 0;
+    for (; j + 4 <= n; j += 4){
+        unsigned long long top = 0, bottom = 0;
+        for (int k = 0; k < 4; k++, ri += step_ri, ci += step_ci){
+            unsigned i = ri >> WARP_SHIFT, a = ci >> WARP_SHIFT;
+            uint16_t s, t;
+            memcpy(&s, src[i] + a, 2);
+            memcpy(&t, src[i + 1] + a, 2);
+            top |= (unsigned long long)s << (16*k);
+            bottom |= (unsigned long long)t << (16*k);
+        }
+
+        // Pares de pesos (1-f, f) en cada carril
+        __m128i fr = _mm_and_si128(_mm_srli_epi32(vr, WARP_SHIFT - WEIGHT_BITS), fraction);
+        __m128i fc = _mm_and_si128(_mm_srli_epi32(vc, WARP_SHIFT - WEIGHT_BITS), fraction);
+        __m128i wr = _mm_or_si128(_mm_sub_epi32(one, fr), _mm_slli_epi32(fr, 16));
+        __m128i wc = _mm_or_si128(_mm_sub_epi32(one, fc), _mm_slli_epi32(fc, 16));
+
+        __m128i h_top = _mm_madd_epi16(_mm_unpacklo_epi8(_mm_cvtsi64_si128(top), zero), wc);
+        __m128i h_bottom = _mm_madd_epi16(_mm_unpacklo_epi8(_mm_cvtsi64_si128(bottom), zero), wc);
+        __m128i v = _mm_madd_epi16(_mm_or_si128(h_top, _mm_slli_epi32(h_bottom, 16)), wr);
+        v = _mm_srli_epi32(_mm_add_epi32(v, half), 2*WEIGHT_BITS);
+
+        __m128i out = _mm_packus_epi16(_mm_packs_epi32(v, v), v);
+        int packed = _mm_cvtsi128_si32(out);
+        memcpy(d + j, &packed, 4);
+
+        vr = _mm_add_epi32(vr, step_r);
+        vc = _mm_add_epi32(vc, step_c);
+    }
+    return j;
+}
+#endif
+
+void Image::WarpInto(Image & out, const AffineTransform & inverse, WarpSampling sampling, byte background,
+                     int first_row, int last_row) const {
+    const double * m = inverse.m;
+    const long long dr = llround(m[1] * WARP_ONE), dc = llround(m[4] * WARP_ONE);
+
+    // Coordenadas que se pueden muestrear: con el vecino más cercano las que
+    // redondean a un píxel, y con la bilineal las que quedan entre píxeles
+    long long row_lo = 0, row_hi = (long long)(rows - 1) << WARP_SHIFT;
+    long long col_lo = 0, col_hi = (long long)(cols - 1) << WARP_SHIFT;
+    if (sampling == WARP_NEAREST){
+        row_lo = col_lo = -WARP_HALF;
+        row_hi += WARP_HALF - 1;
+        col_hi += WARP_HALF - 1;
+    }
+
+#ifdef __SSE2__
+    bool blocks = sampling == WARP_BILINEAR && row_hi < (1LL << 31) && col_hi < (1LL << 31)
+                  && llabs(dr) < (1LL << 28) && llabs(dc) < (1LL << 28);
+#endif
+
+    for (int i = first_row; i < last_row; i++){
+        // Coordenada en la imagen original de la columna 0 de la fila i
+        long long r = llround((m[0]*i + m[2]) * WARP_ONE);
+        long long c = llround((m[3]*i + m[5]) * WARP_ONE);
+
+        long long j0 = 0, j1 = out.cols;
+        ClipSpan(r, dr, row_lo, row_hi, j0, j1);
+        ClipSpan(c, dc, col_lo, col_hi, j0, j1);
+
+        byte * d = out.img[i];
+        if (j0 >= j1){
+            memset(d, background, out.cols);
+            continue;
+        }
+        memset(d, background, j0);
+        memset(d + j1, background, out.cols - j1);
+
+        r += j0 * dr;
+        c += j0 * dc;
+        int j = j0;
+        if (sampling == WARP_NEAREST){
+            for (; j < j1; j++, r += dr, c += dc)
+                d[j] = img[(r + WARP_HALF) >> WARP_SHIFT][(c + WARP_HALF) >> WARP_SHIFT];
+            continue;
+        }
+
+#ifdef __SSE2__
+        // Tramo interior, en el que todos los píxeles tienen vecino siguiente en
+        // fila y columna. Los bordes los calcula el bucle escalar.
+        long long k0 = j0, k1 = j1;
+        ClipSpan(r - j0 * dr, dr, 0, row_hi - 1, k0, k1);
+        ClipSpan(c - j0 * dc, dc, 0, col_hi - 1, k0, k1);
+        if (blocks && k0 < k1){
+            for (; j < k0; j++, r += dr, c += dc)
+                d[j] = Bilinear(img, rows, cols, r, c);
+            int done = WarpBilinearBlocks(img, r, c, dr, dc, d + j, k1 - k0);
+            j += done;
+            r += done * dr;
+            c += done * dc;
+        }
+#endif
+        for (; j < j1; j++, r += dr, c += dc)
+            d[j] = Bilinear(img, rows, cols, r, c);
+    }
+}
+
+/********************************
+      OPERACIONES PÚBLICAS
+********************************/
+
+Image Image::Warp(const AffineTransform & transform, WarpSampling sampling, byte background, int threads) const {
+    return Warp(transform, rows, cols, sampling, background, threads);
+}
+
+// _____________________________________________________________________________
+
+Image Image::Warp(const AffineTransform & transform, int out_rows, int out_cols,
+                  WarpSampling sampling, byte background, int threads) const {
+    IMAGE_PERF_SCOPE("Warp");
+    assert(out_rows >= 0 && out_cols >= 0 && threads >= 1);
+
+    // Cada píxel del resultado se busca en la original con la transformación inversa
+    AffineTransform inverse;
+    bool invertible = transform.Inverse(inverse);
+    assert(invertible);
+    (void)invertible;
+
+    Image out(out_rows, out_cols, background);
+    if (Empty() || out.Empty())
+        return out;
+
+    // Bandas de filas, una por hilo
+    int bands = 1;
+    if ((size_t)out_rows * out_cols >= WARP_PARALLEL_PIXELS)
+        bands = min(threads, out_rows);
+    vector<thread> workers;
+    for (int b = 1; b < bands; b++)
+        workers.push_back(thread([this, &out, &inverse, sampling, background, b, bands]{
+            WarpInto(out, inverse, sampling, background, out.rows * b / bands, out.rows * (b+1) / bands);
+        }));
+    WarpInto(out, inverse, sampling, background, 0, out.rows / bands);
+    for (size_t b = 0; b < workers.size(); b++)
+        workers[b].join();
+
+    return out;
+}
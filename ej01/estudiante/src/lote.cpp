@@ -0,0 +1,161 @@
+/**
+ * @file lote.cpp
+ * @brief Fichero que permite ejecutar cualquiera de las operaciones de los demás ejecutables sobre una lista de imágenes o directorios.
+ *
+ * Las imágenes se leen en paralelo con un ImageLoader mientras se procesa y guarda la anterior.
+ */
+
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <image.h>
+#include <imageloader.h>
+
+using namespace std;
+
+/**
+  * @brief Operación del lote: nombre del ejecutable equivalente y sus parámetros numéricos.
+  */
+struct BatchOp{
+    const char * name;  ///< Nombre de la operación
+    int nparams;        ///< Número de parámetros enteros
+    const char * usage; ///< Descripción de los parámetros
+};
+
+static const BatchOp ops[] = {
+    {"negativo",  0, ""},
+    {"subimagen", 4, "<fila> <columna> <filas_subimagen> <columnas_subimagen>"},
+    {"zoom",      3, "<fila> <columna> <lado>"},
+    {"icono",     1, "<factor>"},
+    {"contraste", 4, "<e1> <e2> <s1> <s2>"},
+    {"barajar",   0, ""},
+    {"rotar",     1, "<grados>"}
+};
+
+static void PrintUsage(){
+    cerr << "Uso: lote [-j hilos_lectura] <operacion> <directorio_resultado> [parametros] <fichero_o_directorio>...\n";
+    cerr << "Operaciones:\n";
+    for (const BatchOp & op : ops)
+        cerr << "   " << op.name << " " << op.usage << "\n";
+}
+
+// Comprueba los parámetros que no dependen de la imagen
+static bool ValidParams(const string & op, const vector<int> & p){
+    if (op == "icono")
+        return p[0] > 0;
+    if (op == "contraste")
+        return 0 <= p[0] && p[0] < p[1] && p[1] <= 255 && 0 <= p[2] && p[2] < p[3] && p[3] <= 255;
+    return true;
+}
+
+// Comprueba que la región de subimagen o zoom está dentro de la imagen
+static bool RegionInside(const string & op, const vector<int> & p, const Image & image){
+    if (op != "subimagen" && op != "zoom")
+        return true;
+    int height = p[2], width = op == "zoom" ? p[2] : p[3];
+    return p[0] >= 0 && p[1] >= 0 && height >= 0 && width >= 0 &&
+           (long)p[0] + height <= image.get_rows() && (long)p[1] + width <= image.get_cols();
+}
+
+// Aplica la operación a la imagen, igual que el ejecutable del mismo nombre
+static Image Apply(const string & op, const vector<int> & p, Image & image){
+    if (op == "negativo"){
+        image.Invert();
+        return move(image);
+    }
+    if (op == "subimagen")
+        return image.Crop(p[0], p[1], p[2], p[3]);
+    if (op == "zoom")
+        return image.Crop(p[0], p[1], p[2], p[2]).Zoom2X();
+    if (op == "icono")
+        return image.Subsample(p[0]);
+    if (op == "contraste"){
+        image.AdjustContrast(p[0], p[1], p[2], p[3]);
+        return move(image);
+    }
+    if (op == "rotar"){
+        double center_row = (image.get_rows() - 1) / 2.0, center_col = (image.get_cols() - 1) / 2.0;
+        return image.Warp(AffineTransform::Rotation(p[0], center_row, center_col));
+    }
+    image.ShuffleRows();
+    return move(image);
+}
+
+int main (int argc, char *argv[]){
+
+    int io_threads = 2;
+    int arg = 1;
+
+    // Obtener argumentos
+    if (argc > 2 && strcmp(argv[1], "-j") == 0){
+        io_threads = atoi(argv[2]);
+        arg = 3;
+    }
+
+    const BatchOp * op = 0;
+    if (arg < argc)
+        for (const BatchOp & candidate : ops)
+            if (strcmp(argv[arg], candidate.name) == 0)
+                op = &candidate;
+
+    // Comprobar validez de la llamada
+    if (io_threads <= 0 || op == 0 || argc < arg + 3 + op->nparams){
+        cerr << "Error: Numero incorrecto de parametros.\n";
+        PrintUsage();
+        exit (1);
+    }
+
+    string destino = argv[arg + 1];
+    vector<int> params;
+    for (int k = 0; k < op->nparams; k++)
+        params.push_back(atoi(argv[arg + 2 + k]));
+    if (!ValidParams(op->name, params)){
+        cerr << "Error: Parametros no validos para " << op->name << ".\n";
+        PrintUsage();
+        exit (1);
+    }
+
+    vector<string> inputs(argv + arg + 2 + op->nparams, argv + argc);
+    vector<string> files = ExpandImagePaths(inputs);
+
+    cout << "Operacion: " << op->name << endl;
+    cout << "Directorio resultado: " << destino << endl;
+    cout << "Imagenes: " << files.size() << endl;
+
+    // Lectura en paralelo: mientras se procesa una imagen se leen las siguientes
+    ImageLoader loader(files, io_threads);
+    LoadedImage item;
+    int errors = 0;
+
+    while (loader.Next(item)){
+        if (item.result != SUCCESS){
+            cerr << "Error: No pudo leerse la imagen " << item.path << " ("
+                 << LoadResultMessage(item.result) << ")." << endl;
+            errors++;
+            continue;
+        }
+        if (!RegionInside(op->name, params, item.image)){
+            cerr << "Error: No pudo procesarse la imagen " << item.path << " ("
+                 << LoadResultMessage(BAD_REGION) << ")." << endl;
+            errors++;
+            continue;
+        }
+
+        Image result = Apply(op->name, params, item.image);
+
+        size_t slash = item.path.find_last_of('/');
+        string salida = destino + "/" + (slash == string::npos ? item.path : item.path.substr(slash + 1));
+        bool pgb = salida.size() > 4 && salida.compare(salida.size() - 4, 4, ".pgb") == 0;
+        if (pgb ? result.SaveCompressed(salida.c_str()) : result.Save(salida.c_str()))
+            cout << item.path << " -> " << salida << endl;
+        else{
+            cerr << "Error: No pudo guardarse la imagen " << salida << "." << endl;
+            errors++;
+        }
+    }
+
+    return errors == 0 ? 0 : 1;
+}
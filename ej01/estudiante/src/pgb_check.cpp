@@ -0,0 +1,223 @@
+/**
+ * @file pgb_check.cpp
+ * @brief Fichero que comprueba la escritura y lectura de imágenes PGB, también con archivos dañados.
+ *
+ * Guarda en PGB imágenes de distintos tamaños, contenidos y filas por bloque, y
+ * comprueba que LoadImageFile, LoadPGBRows y LoadImageRegion devuelven los mismos
+ * píxeles. Después lee archivos con la cabecera, el índice o los bloques dañados:
+ * ninguno puede leerse con éxito (salvo los cambios aleatorios, que sólo tienen
+ * que leerse sin fallos de memoria). Termina con código 1 si encuentra algún error.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <imageIO.h>
+
+using namespace std;
+
+// Cambios aleatorios de un byte que se prueban sobre un archivo válido
+static const int RANDOM_MUTATIONS = 2000;
+
+// Generador pseudoaleatorio
+static unsigned Next(unsigned long long & state){
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (unsigned)(state >> 33);
+}
+
+// Imagen de prueba: 0 gradiente, 1 ruido, 2 constante, 3 gradiente con ruido
+static vector<unsigned char> MakePixels(int kind, int rows, int cols, unsigned long long & state){
+    vector<unsigned char> data((size_t)rows*cols);
+    for (int i = 0; i < rows; i++)
+        for (int j = 0; j < cols; j++){
+            unsigned char v;
+            switch (kind){
+                case 0:  v = (unsigned char)(i + 2*j); break;
+                case 1:  v = (unsigned char)Next(state); break;
+                case 2:  v = 77; break;
+                default: v = (unsigned char)(i + j + Next(state) % 8); break;
+            }
+            data[(size_t)i*cols + j] = v;
+        }
+    return data;
+}
+
+static vector<unsigned char> ReadBytes(const string & path){
+    ifstream f(path.c_str(), ios::binary);
+    return vector<unsigned char>(istreambuf_iterator<char>(f), istreambuf_iterator<char>());
+}
+
+static void WriteBytes(const string & path, const vector<unsigned char> & bytes){
+    ofstream f(path.c_str(), ios::binary | ios::trunc);
+    f.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+}
+
+static void PutU32(vector<unsigned char> & bytes, size_t at, unsigned v){
+    for (int k = 0; k < 4; k++)
+        bytes[at + k] = (unsigned char)(v >> (8*k));
+}
+
+// Guarda una imagen en PGB y la lee completa, por filas y por regiones. Devuelve el número de errores.
+static long RoundTrip(const string & path, const vector<unsigned char> & pixels, int rows, int cols,
+                      int band_rows, unsigned long long & state){
+    long errors = 0;
+    if (!WritePGBImage(path.c_str(), pixels.data(), rows, cols, band_rows))
+        return 1;
+
+    unsigned char *data = 0;
+    int r = 0, c = 0;
+    if (LoadImageFile(path.c_str(), data, r, c) != SUCCESS || r != rows || c != cols ||
+        !equal(pixels.begin(), pixels.end(), data))
+        errors++;
+    delete[] data;
+
+    for (int t = 0; t < 3; t++){
+        int first = Next(state) % rows, count = 1 + Next(state) % rows;
+        int got = min(count, rows - first);
+        data = 0;
+        if (LoadPGBRows(path.c_str(), first, count, data, r, c) != SUCCESS ||
+            !equal(pixels.begin() + (size_t)first*cols, pixels.begin() + (size_t)(first+got)*cols, data))
+            errors++;
+        delete[] data;
+
+        int row = Next(state) % rows, col = Next(state) % cols;
+        int height = 1 + Next(state) % (rows - row), width = 1 + Next(state) % (cols - col);
+        data = 0;
+        if (LoadImageRegion(path.c_str(), row, col, height, width, data, r, c) != SUCCESS)
+            errors++;
+        else
+            for (int i = 0; i < height; i++)
+                if (!equal(data + (size_t)i*width, data + (size_t)(i+1)*width,
+                           pixels.begin() + (size_t)(row+i)*cols + col))
+                    errors++;
+        delete[] data;
+    }
+    return errors;
+}
+
+// Lee un archivo dañado con todas las funciones de lectura de PGB. Devuelve
+// el número de errores: lecturas con éxito si must_fail, o resultados incoherentes.
+static long ReadDamaged(const string & path, bool must_fail){
+    long errors = 0;
+    unsigned char *data = 0;
+    int r = 0, c = 0;
+
+    LoadResult res = LoadImageFile(path.c_str(), data, r, c);
+    if ((res == SUCCESS) != (data != 0) || (must_fail && res == SUCCESS))
+        errors++;
+    delete[] data;
+
+    data = 0;
+    res = LoadPGBRows(path.c_str(), 1, 10, data, r, c);
+    if (must_fail && res == SUCCESS)
+        errors++;
+    delete[] data;
+
+    data = 0;
+    res = LoadImageRegion(path.c_str(), 2, 3, 20, 20, data, r, c);
+    if (must_fail && res == SUCCESS)
+        errors++;
+    delete[] data;
+    return errors;
+}
+
+int main(int argc, char *argv[]){
+
+    string tmp_dir = ".";
+
+    // Comprobar validez de la llamada
+    if (argc > 2){
+        cerr << "Error: Numero incorrecto de parametros.\n";
+        cerr << "Uso: pgb_check [<directorio_temporal>]\n";
+        exit (1);
+    }
+    if (argc > 1)
+        tmp_dir = argv[1];
+
+    const string path = tmp_dir + "/pgb_check.tmp.pgb";
+    const string damaged = tmp_dir + "/pgb_check.tmp.damaged.pgb";
+    unsigned long long state = 1;
+    long errors = 0;
+
+    // Ida y vuelta
+    const int sizes[][2] = {{1, 1}, {1, 300}, {300, 1}, {53, 98}, {257, 300}, {1100, 1000}};
+    long cases = 0;
+    for (const int * size : sizes)
+        for (int kind = 0; kind < 4; kind++)
+            for (int band_rows : {0, 1, 7, size[0]}){
+                vector<unsigned char> pixels = MakePixels(kind, size[0], size[1], state);
+                errors += RoundTrip(path, pixels, size[0], size[1], band_rows, state);
+                cases++;
+            }
+    cout << "Ida y vuelta: " << cases << " imagenes, " << errors << " errores" << endl;
+
+    // Archivo válido de 53x98 en 5 bloques de 13 filas, sobre el que se hacen los daños
+    vector<unsigned char> pixels = MakePixels(3, 53, 98, state);
+    WritePGBImage(path.c_str(), pixels.data(), 53, 98, 13);
+    const vector<unsigned char> valid = ReadBytes(path);
+    const size_t header = 20, entry = 13, index_end = header + 5*entry;
+
+    struct Damage{
+        const char * name;
+        vector<unsigned char> bytes;
+    };
+    vector<Damage> damages;
+    vector<unsigned char> b;
+
+    // Un único bloque de band_rows = 0x8004003d filas: negativo como int
+    b.assign(valid.begin(), valid.begin() + header);
+    PutU32(b, 12, 0x8004003du);
+    PutU32(b, 16, 1);
+    b.resize(header + entry + 30, 0);
+    PutU32(b, header, header + entry);
+    PutU32(b, header + 8, 30);
+    b[header + 12] = 1;
+    damages.push_back({"band_rows enorme", b});
+
+    b = valid; PutU32(b, 12, 54); PutU32(b, 16, 1);                 damages.push_back({"band_rows > filas", b});
+    b = valid; PutU32(b, 12, 0);                                    damages.push_back({"band_rows = 0", b});
+    b = valid; PutU32(b, 16, 6);                                    damages.push_back({"numero de bloques", b});
+    b = valid; PutU32(b, 4, 0);                                     damages.push_back({"filas = 0", b});
+    b = valid; PutU32(b, 8, 0);                                     damages.push_back({"columnas = 0", b});
+    b = valid; PutU32(b, 4, 1u << 31);                              damages.push_back({"filas enormes", b});
+    b.assign(valid.begin(), valid.begin() + header - 1);            damages.push_back({"cabecera cortada", b});
+    b.assign(valid.begin(), valid.begin() + index_end - 5);         damages.push_back({"indice cortado", b});
+    b.assign(valid.begin(), valid.end() - 1);                       damages.push_back({"bloque cortado", b});
+    b = valid; b[header + 12] = 9;                                  damages.push_back({"metodo desconocido", b});
+    b = valid; PutU32(b, header, valid.size() + 1);                 damages.push_back({"bloque fuera del archivo", b});
+    b = valid; PutU32(b, header + 8, 0);                            damages.push_back({"bloque vacio", b});
+
+    long damage_errors = 0;
+    for (const Damage & d : damages){
+        WriteBytes(damaged, d.bytes);
+        long e = ReadDamaged(damaged, true);
+        if (e > 0)
+            cerr << "Error: se ha leido el archivo danado (" << d.name << ")" << endl;
+        damage_errors += e;
+    }
+    cout << "Archivos danados: " << damages.size() << ", " << damage_errors << " errores" << endl;
+
+    // Cambios aleatorios, sobre todo en la cabecera y el índice
+    long random_errors = 0;
+    for (int t = 0; t < RANDOM_MUTATIONS; t++){
+        b = valid;
+        size_t at = t % 2 == 0 ? Next(state) % index_end : Next(state) % b.size();
+        b[at] ^= (unsigned char)(1 + Next(state) % 255);
+        WriteBytes(damaged, b);
+        random_errors += ReadDamaged(damaged, false);
+    }
+    cout << "Cambios aleatorios: " << RANDOM_MUTATIONS << ", " << random_errors << " errores" << endl;
+
+    errors += damage_errors + random_errors;
+    remove(path.c_str());
+    remove(damaged.c_str());
+
+    cout << endl << "Comprobacion: " << errors << " errores" << endl;
+    return errors == 0 ? 0 : 1;
+}
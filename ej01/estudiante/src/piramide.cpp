@@ -0,0 +1,83 @@
+/**
+ * @file piramide.cpp
+ * @brief Fichero que permite construir la pirámide de resoluciones de una imagen (ver ImagePyramid) y guardarla en un archivo.
+ *
+ * Opcionalmente extrae un nivel del archivo guardado como imagen PGM.
+ */
+
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <thread>
+
+#include <image.h>
+#include <imagepyramid.h>
+
+using namespace std;
+
+int main (int argc, char *argv[]){
+
+    char *origen, *destino; // nombres de los ficheros
+    Image image;
+
+    // Comprobar validez de la llamada
+    if (argc != 3 && argc != 5){
+        cerr << "Error: Numero incorrecto de parametros.\n";
+        cerr << "Uso: piramide <FichImagenOriginal> <FichPiramide> [<nivel> <FichNivel>]\n";
+        exit (1);
+    }
+
+    // Obtener argumentos
+    origen  = argv[1];
+    destino = argv[2];
+
+    // Mostramos argumentos
+    cout << endl;
+    cout << "Fichero origen: " << origen << endl;
+    cout << "Fichero piramide: " << destino << endl;
+
+    // Leer la imagen del fichero de entrada
+    LoadResult load_result = image.LoadWithStatus(origen);
+    if (load_result != SUCCESS){
+        cerr << "Error: No pudo leerse la imagen (" << LoadResultMessage(load_result) << ")." << endl;
+        cerr << "Terminando la ejecucion del programa." << endl;
+        return 1;
+    }
+
+    // Construir la pirámide: cada nivel a partir del anterior
+    ImagePyramid pyramid(image, 1, max(1u, thread::hardware_concurrency()));
+
+    cout << endl;
+    cout << "Niveles de " << origen << ":" << endl;
+    for (int k = 0; k < pyramid.size(); k++)
+        cout << "   Nivel " << k << " = " << pyramid.level(k).get_rows() << " filas x "
+             << pyramid.level(k).get_cols() << " columnas " << endl;
+
+    // Guardar la pirámide en el fichero
+    if (pyramid.Save(destino))
+        cout  << "La piramide se guardo en " << destino << endl;
+    else{
+        cerr << "Error: No pudo guardarse la piramide." << endl;
+        cerr << "Terminando la ejecucion del programa." << endl;
+        return 1;
+    }
+
+    // Extraer un nivel del fichero guardado
+    if (argc == 5){
+        int nivel = atoi(argv[3]);
+        Image level;
+        load_result = ImagePyramid::LoadLevel(destino, nivel, level);
+        if (load_result != SUCCESS){
+            cerr << "Error: No pudo leerse el nivel " << nivel << " (" << LoadResultMessage(load_result) << ")." << endl;
+            return 1;
+        }
+        if (level.Save(argv[4]))
+            cout  << "El nivel " << nivel << " se guardo en " << argv[4] << endl;
+        else{
+            cerr << "Error: No pudo guardarse el nivel." << endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
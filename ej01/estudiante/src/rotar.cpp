@@ -0,0 +1,80 @@
+/**
+ * @file rotar.cpp
+ * @brief Fichero que permite girar una imagen, y opcionalmente corregir su inclinación, con el método Warp.
+ *
+ * La imagen se gira alrededor de su centro y, si se indica una cizalla, después se
+ * desplaza cada fila horizontalmente en proporción a su distancia al centro, como
+ * para enderezar un escaneo inclinado. El resultado tiene las mismas dimensiones
+ * que la original y los píxeles que quedan fuera de ella son negros.
+ */
+
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <thread>
+
+#include <image.h>
+
+using namespace std;
+
+int main (int argc, char *argv[]){
+
+    char *origen, *destino; // nombres de los ficheros
+    double grados, cizalla = 0;
+    Image image, rotated;
+
+    // Comprobar validez de la llamada
+    if (argc != 4 && argc != 5){
+        cerr << "Error: Numero incorrecto de parametros.\n";
+        cerr << "Uso: rotar <FichImagenOriginal> <FichImagenDestino> <grados> [<cizalla>]\n";
+        exit (1);
+    }
+
+    // Obtener argumentos
+    origen  = argv[1];
+    destino = argv[2];
+    grados = atof(argv[3]);
+    if (argc == 5)
+        cizalla = atof(argv[4]);
+
+    // Mostramos argumentos
+    cout << endl;
+    cout << "Fichero origen: " << origen << endl;
+    cout << "Fichero resultado: " << destino << endl;
+    cout << "Grados: " << grados << endl;
+    cout << "Cizalla: " << cizalla << endl;
+
+    // Leer la imagen del fichero de entrada
+    LoadResult load_result = image.LoadWithStatus(origen);
+    if (load_result != SUCCESS){
+        cerr << "Error: No pudo leerse la imagen (" << LoadResultMessage(load_result) << ")." << endl;
+        cerr << "Terminando la ejecucion del programa." << endl;
+        return 1;
+    }
+
+    // Mostrar los parametros de la Imagen
+    cout << endl;
+    cout << "Dimensiones de " << origen << ":" << endl;
+    cout << "   Imagen   = " << image.get_rows()  << " filas x " << image.get_cols() << " columnas " << endl;
+
+    // Giro y cizalla alrededor del centro
+    double center_row = (image.get_rows() - 1) / 2.0, center_col = (image.get_cols() - 1) / 2.0;
+    AffineTransform transform = AffineTransform::Rotation(grados, center_row, center_col)
+        .Then(AffineTransform::Translation(-center_row, -center_col))
+        .Then(AffineTransform::Shear(0, cizalla))
+        .Then(AffineTransform::Translation(center_row, center_col));
+
+    int threads = max(1u, thread::hardware_concurrency());
+    rotated = image.Warp(transform, WARP_BILINEAR, 0, threads);
+
+    // Guardar la imagen resultado en el fichero
+    if (rotated.Save(destino))
+        cout  << "La imagen se guardo en " << destino << endl;
+    else{
+        cerr << "Error: No pudo guardarse la imagen." << endl;
+        cerr << "Terminando la ejecucion del programa." << endl;
+        return 1;
+    }
+
+    return 0;
+}
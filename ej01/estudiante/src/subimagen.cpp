@@ -15,7 +15,7 @@ int main (int argc, char *argv[]){
 
     char *origen, *destino; // nombres de los ficheros
     int fila, col, nfils, ncols ;
-    Image image, result ;
+    Image result ;
 
     // Comprobar validez de la llamada
     if (argc != 7){
@@ -41,9 +41,11 @@ int main (int argc, char *argv[]){
     cout << "Filas subimagen: " << nfils << endl ;
     cout << "Columnas subimagen: " << ncols << endl ;
 
-    // Leer la imagen del fichero de entrada
-    if (!image.Load(origen)){
-        cerr << "Error: No pudo leerse la imagen." << endl;
+    // Leer del fichero de entrada sólo la subimagen
+    int rows, cols;
+    LoadResult load_result = result.LoadRegion(origen, fila, col, nfils, ncols, rows, cols);
+    if (load_result != SUCCESS){
+        cerr << "Error: No pudo leerse la imagen (" << LoadResultMessage(load_result) << ")." << endl;
         cerr << "Terminando la ejecucion del programa." << endl;
         return 1;
     }
@@ -51,10 +53,7 @@ int main (int argc, char *argv[]){
     // Mostrar los parametros de la Imagen
     cout << endl;
     cout << "Dimensiones de " << origen << ":" << endl;
-    cout << "   Imagen   = " << image.get_rows()  << " filas x " << image.get_cols() << " columnas " << endl;
-
-    // Calcular la subimagen.
-    result = image.Crop(fila, col, nfils, ncols) ;
+    cout << "   Imagen   = " << rows  << " filas x " << cols << " columnas " << endl;
 
     // Guardar la imagen resultado en el fichero
     if (result.Save(destino))
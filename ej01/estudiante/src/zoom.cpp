@@ -15,7 +15,7 @@ int main (int argc, char *argv[]){
 
     char *origen, *destino; // nombres de los ficheros
     int fila, col, lado ;
-    Image image, result , zoomed;
+    Image result , zoomed;
 
     // Comprobar validez de la llamada
     if (argc != 6){
@@ -39,9 +39,11 @@ int main (int argc, char *argv[]){
     cout << "Columna: " << col << endl ;
     cout << "Lado del cuadrado: " << lado << endl ;
 
-    // Leer la imagen del fichero de entrada
-    if (!image.Load(origen)){
-        cerr << "Error: No pudo leerse la imagen." << endl;
+    // Leer del fichero de entrada sólo la subimagen
+    int rows, cols;
+    LoadResult load_result = result.LoadRegion(origen, fila, col, lado, lado, rows, cols);
+    if (load_result != SUCCESS){
+        cerr << "Error: No pudo leerse la imagen (" << LoadResultMessage(load_result) << ")." << endl;
         cerr << "Terminando la ejecucion del programa." << endl;
         return 1;
     }
@@ -49,10 +51,7 @@ int main (int argc, char *argv[]){
     // Mostrar los parametros de la Imagen
     cout << endl;
     cout << "Dimensiones de " << origen << ":" << endl;
-    cout << "   Imagen   = " << image.get_rows()  << " filas x " << image.get_cols() << " columnas " << endl;
-
-    // Calcular la subimagen.
-    result = image.Crop(fila, col, lado, lado) ;
+    cout << "   Imagen   = " << rows  << " filas x " << cols << " columnas " << endl;
 
     // Calcular el zoom.
     zoomed = result.Zoom2X() ;
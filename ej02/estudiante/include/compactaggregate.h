@@ -0,0 +1,319 @@
+/**
+ * @file compactaggregate.h
+ * @brief  Archivo de especificación de los TDA CompactAggregateStack y CompactSlidingAggregate
+ * @author Pablo García Bas
+ * @author Andrés Gutiérrez Armenteros
+ */
+
+#ifndef _COMPACT_AGGREGATE_H_
+#define _COMPACT_AGGREGATE_H_
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+
+#include "ringbuffer.h"
+#include "slidingaggregate.h"
+
+/**
+  @brief Operación Op con los operandos intercambiados: op(b, a).
+**/
+template <typename Op>
+struct Flipped{
+    Op op;          ///< Operación original
+
+    template <typename T>
+    T operator()(const T & a, const T & b) const { return op(b, a); }
+};
+
+/**
+  @brief T.D.A. CompactAggregateStack
+
+  Una instancia del tipo de dato abstracto CompactAggregateStack es una pila LIFO de
+  valores de tipo T que conoce en todo momento el agregado (con la operación asociativa
+  Op) de todos sus elementos, como AggregateStack, pero que no guarda un agregado por
+  elemento: guarda los valores seguidos y, aparte, una pila de tramos (agregado,
+  número de elementos) que sólo crece cuando cambia el agregado.
+
+  Con operaciones como el máximo o el mínimo, en las que el agregado cambia pocas
+  veces, ocupa casi la mitad que AggregateStack (con int, 4 bytes por elemento más
+  8 por tramo, frente a 8 por elemento). En el peor caso, cuando el agregado cambia
+  en cada push (p.e. con el máximo de una secuencia creciente o con la suma), ocupa
+  un 50% más. T tiene que poder compararse con ==. Todas las operaciones tienen coste
+  O(1) (push amortizado si Capacity == 0, como en AggregateStack).
+
+  \#include <compactaggregate.h>
+
+  @author Andrés Gutiérrez
+  @author Pablo García
+
+**/
+template <typename T, typename Op, typename Element = AggregateElement<T>, size_t Capacity = 0>
+class CompactAggregateStack{
+    /**
+     @page page_repCompactAggregateStack Representación de CompactAggregateStack
+
+     @section sec_Compact_Aggregate_Stack CompactAggregateStack
+
+     Los valores están en un RingBuffer, del fondo al tope. En otro RingBuffer, runs, hay un tramo {aggregate, count} por cada grupo de elementos consecutivos con el mismo agregado desde el fondo: el primer tramo abarca los count primeros elementos, el segundo los count siguientes... El agregado de la pila es el del último tramo.
+
+     push calcula el agregado nuevo y, si es igual que el del último tramo, sólo aumenta su count (salvo que ya valga UINT_MAX); si no, añade un tramo con count 1. pop disminuye el count del último tramo y lo quita si llega a 0.
+
+   **/
+private:
+
+    /// Tramo de elementos consecutivos con el mismo agregado
+    struct Run{
+        T aggregate;        ///< Agregado desde el fondo hasta cualquier elemento del tramo
+        unsigned count;     ///< Número de elementos del tramo
+    };
+
+    RingBuffer<T, Capacity> values;     ///< Valores desde el fondo, con el tope al final
+    RingBuffer<Run, Capacity> runs;     ///< Tramos desde el fondo
+    Op op;                              ///< Operación de agregación
+
+    /**
+      * @brief Añade un valor recién insertado a los tramos.
+      */
+    void add_to_runs(const T & val){
+        if (runs.empty()){
+            Run r = {val, 1};
+            runs.push_back(r);
+            return;
+        }
+        T aggregate = op(runs.back().aggregate, val);
+        if (aggregate == runs.back().aggregate && runs.back().count < UINT_MAX)
+            runs.back().count++;
+        else{
+            Run r = {aggregate, 1};
+            runs.push_back(r);
+        }
+    }
+
+public:
+
+    /**
+      * @brief Constructor.
+      * @param operation Operación de agregación. Por defecto, Op().
+      */
+    explicit CompactAggregateStack(const Op & operation = Op()) : op(operation) {}
+
+    /**
+      * @brief Inserta un valor en el tope de la pila.
+      * @param val Valor a insertar.
+      * @pre Si la capacidad es fija, size() < Capacity.
+      * @post Coste O(1) (amortizado si la pila tiene que crecer).
+      */
+    void push(const T & val){
+        values.push_back(val);
+        add_to_runs(val);
+    }
+
+    /**
+      * @brief Inserta en la pila los valores de [first, last), en orden (el último queda en el tope).
+      *
+      * Hace lo mismo que push() con cada valor, pero escribe los valores seguidos en el buffer.
+      *
+      * @param first Primer valor.
+      * @param last Fin de los valores.
+      * @post Coste O(1) amortizado por valor.
+      */
+    template <typename InputIt>
+    void push_range(InputIt first, InputIt last){
+        while (first != last){
+            size_t n = (size_t)-1;
+            T * slot = values.back_slots(n);
+            size_t k = 0;
+            for (; k < n && first != last; ++k, ++first){
+                slot[k] = *first;
+                add_to_runs(slot[k]);
+            }
+            values.commit_back(k);
+        }
+    }
+
+    /**
+      * @brief Elimina los n elementos del _tope_ de la pila.
+      * @param n Número de elementos. Si es mayor que size(), se vacía la pila.
+      * @post Coste O(1) por tramo eliminado, a lo sumo O(n).
+      */
+    void pop_n(int n){
+        size_t k = std::min((size_t)std::max(n, 0), values.size());
+        values.pop_back_n(k);
+        while (k > 0){
+            Run & last = runs.back();
+            if (last.count > k){
+                last.count -= k;
+                break;
+            }
+            k -= last.count;
+            runs.pop_back();
+        }
+    }
+
+    /**
+      * @brief Copia los valores de los n elementos del tope, desde el tope hacia el fondo.
+      * @param n Número de elementos.
+      * @param out Destino de los valores.
+      * @pre 0 <= n <= size()
+      * @return out después del último valor copiado. Coste O(n).
+      */
+    template <typename OutputIt>
+    OutputIt top_n(int n, OutputIt out) const {
+        for (int i = 1; i <= n; i++, ++out)
+            *out = values[values.size() - i];
+        return out;
+    }
+
+    /**
+      * @brief Elimina el elemento del _tope_ de la pila.
+      * @post La pila pasa a tener un elemento menos (si estaba vacía, no se modifica). Coste O(1).
+      */
+    void pop(){
+        if (values.empty())
+            return;
+        values.pop_back();
+        if (--runs.back().count == 0)
+            runs.pop_back();
+    }
+
+    /**
+      * @brief Muestra el elemento del _tope_ de la pila.
+      * @pre pila no vacía.
+      * @return El valor del tope y el agregado de la pila.
+      */
+    Element top() const { return Element{values.back(), runs.back().aggregate}; }
+
+    /**
+      * @brief Agregado de todos los elementos de la pila.
+      * @pre pila no vacía.
+      * @return op(fondo, ..., tope).
+      */
+    T aggregate() const { return runs.back().aggregate; }
+
+    /**
+      * @brief Reserva espacio para que quepan n valores sin volver a reservar memoria.
+      * @param n Número de valores.
+      * @pre Si la capacidad es fija, n <= Capacity.
+      */
+    void reserve(size_t n){ values.reserve(n); }
+
+    /**
+      * @brief Indica si la pila está o no vacía.
+      * @return true si la pila está vacía.
+      */
+    bool empty() const { return values.empty(); }
+
+    /**
+      * @brief Indica el número de elementos que hay actualmente en la pila.
+      * @return Número de elementos.
+      */
+    int size() const { return values.size(); }
+
+    /**
+      * @brief Número de tramos con el mismo agregado.
+      * @return Entre 1 y size() si la pila no está vacía.
+      */
+    int run_count() const { return runs.size(); }
+};
+
+/**
+  @brief T.D.A. CompactSlidingAggregate
+
+  Una instancia del tipo de dato abstracto CompactSlidingAggregate es una cola FIFO con
+  el agregado de todos sus elementos, como SlidingAggregate, formada por dos
+  CompactAggregateStack, así que ocupa casi la mitad cuando el agregado cambia pocas
+  veces. A cambio, push y pop tienen coste O(1) amortizado, no en el peor caso: cuando
+  se vacía la pila de salida se le pasan todos los elementos de la de entrada.
+
+  \#include <compactaggregate.h>
+
+  @author Andrés Gutiérrez
+  @author Pablo García
+
+**/
+template <typename T, typename Op, typename Element = AggregateElement<T> >
+class CompactSlidingAggregate{
+    /**
+     @page page_repCompactSlidingAggregate Representación de CompactSlidingAggregate
+
+     @section sec_Compact_Sliding_Aggregate CompactSlidingAggregate
+
+     La cola se reparte entre dos pilas: in, en la que se insertan los valores nuevos, y out, de la que se sacan (el frente de la cola en el tope). Como en out los valores están en orden inverso al de la cola, usa la operación con los operandos intercambiados, y su agregado es el de sus valores en el orden de la cola. El agregado de la cola es op(agregado de out, agregado de in).
+
+     Si la cola no está vacía, out tampoco: push inserta en out si está vacía, y cuando pop vacía out se le pasan todos los valores de in, del más reciente al más antiguo.
+
+   **/
+private:
+
+    CompactAggregateStack<T, Flipped<Op> > out;     ///< Valores más antiguos (el frente en el tope)
+    CompactAggregateStack<T, Op> in;                ///< Valores más recientes (el último en el tope)
+    Op op;                                          ///< Operación de agregación
+
+public:
+
+    /**
+      * @brief Constructor.
+      * @param operation Operación de agregación. Por defecto, Op().
+      */
+    explicit CompactSlidingAggregate(const Op & operation = Op())
+        : out(Flipped<Op>{operation}), in(operation), op(operation) {}
+
+    /**
+      * @brief Añade un valor al final de la cola.
+      * @param new_value Valor a añadir.
+      * @post La cola se modifica. Coste O(1) amortizado.
+      */
+    void push(const T & new_value){
+        if (out.empty())
+            out.push(new_value);
+        else
+            in.push(new_value);
+    }
+
+    /**
+      * @brief Elimina el elemento del frente de la cola.
+      * @pre La cola no está vacía.
+      * @post La cola se modifica. Coste O(1) amortizado.
+      */
+    void pop(){
+        out.pop();
+        if (out.empty())
+            while (!in.empty()){
+                out.push(in.top().value);
+                in.pop();
+            }
+    }
+
+    /**
+      * @brief Accede al elemento en el frente de la cola.
+      * @pre La cola no está vacía.
+      * @return El valor del frente y el agregado de toda la cola.
+      */
+    Element front() const { return Element{out.top().value, aggregate()}; }
+
+    /**
+      * @brief Agregado de todos los elementos de la cola.
+      * @pre La cola no está vacía.
+      * @return op(frente, ..., final).
+      */
+    T aggregate() const {
+        if (in.empty())
+            return out.aggregate();
+        return op(out.aggregate(), in.aggregate());
+    }
+
+    /**
+      * @brief Devuelve el tamaño actual de la cola (numero de elementos).
+      * @return El tamaño (entero).
+      */
+    int size() const { return out.size() + in.size(); }
+
+    /**
+      * @brief Comprueba si la cola esta o no vacia.
+      * @return true si la cola esta vacia.
+      */
+    bool empty() const { return out.empty(); }
+};
+
+#endif // _COMPACT_AGGREGATE_H_
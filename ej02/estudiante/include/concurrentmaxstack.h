@@ -0,0 +1,304 @@
+/**
+ * @file concurrentmaxstack.h
+ * @brief  Archivo de especificación del TDA ConcurrentMaxStack
+ * @author Pablo García Bas
+ * @author Andrés Gutiérrez Armenteros
+ */
+
+#ifndef _CONCURRENT_MAX_STACK_H_
+#define _CONCURRENT_MAX_STACK_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#include "slidingaggregate.h"
+
+/**
+  @brief T.D.A. ConcurrentMaxStack
+
+  Una instancia del tipo de dato abstracto ConcurrentMaxStack es una pila LIFO con
+  máximo que pueden usar a la vez varios hilos sin cerrojos (pila de Treiber). Cada
+  nodo guarda su valor y el máximo de la pila desde él hasta el fondo, así que la
+  consulta del tope devuelve el máximo en O(1).
+
+  Cada hilo accede a la pila a través de su propio Handle, que no se comparte entre
+  hilos. Los nodos sacados no se liberan: vuelven a una reserva del hilo cuando
+  ningún otro hilo puede estar leyéndolos (punteros de riesgo, _hazard pointers_), y
+  la memoria se libera al destruir la pila.
+
+  \code
+  ConcurrentMaxStack<int> stack;
+  // En cada hilo:
+  ConcurrentMaxStack<int>::Handle h(stack);
+  h.push(result);
+  AggregateElement<int> top;
+  if (h.top(top))
+      cout << top.aggregate << endl;     // máximo de la pila
+  \endcode
+
+  \#include <concurrentmaxstack.h>
+
+  @author Andrés Gutiérrez
+  @author Pablo García
+
+**/
+template <typename T, typename Element = AggregateElement<T> >
+class ConcurrentMaxStack{
+    /**
+     @page page_repConcurrentMaxStack Representación de ConcurrentMaxStack
+
+     @section sec_Concurrent_Max_Stack ConcurrentMaxStack
+
+     La pila es una lista enlazada de nodos {value, maximum, next} desde el tope, que es un puntero atómico. Un nodo no se modifica mientras está en la pila, y _maximum_ es el mayor entre _value_ y el _maximum_ del nodo siguiente. push y pop cambian el tope con compare_exchange y lo reintentan si otro hilo lo ha cambiado antes.
+
+     Cada hilo con un Handle tiene un registro con un puntero de riesgo: antes de leer los campos del nodo del tope lo anuncia en él y comprueba que sigue siendo el tope. Un nodo sacado se guarda en la lista de retirados del registro y, cuando hay bastantes, se pasan a su lista de nodos libres los que no están en el puntero de riesgo de ningún registro. Así un nodo no se reutiliza mientras otro hilo lo lee, y compare_exchange no puede confundir un nodo con otro que ocupe la misma dirección (problema ABA).
+
+     Los nodos nuevos salen de la lista de libres del registro. Si está vacía, se toman NODES_PER_CHUNK nodos de la reserva común, spare, o de un bloque nuevo; y si tiene más de 2 * NODES_PER_CHUNK, se devuelven NODES_PER_CHUNK a spare, para que los nodos que libera un hilo que saca más de lo que inserta lleguen a los que insertan más. spare y la lista de bloques están protegidos por el único cerrojo de la estructura, que se toma como mucho una vez cada NODES_PER_CHUNK operaciones de un hilo. Los registros se reutilizan cuando se destruye su Handle.
+
+   **/
+private:
+
+    static const size_t CACHE_LINE = 64;
+    static const size_t NODES_PER_CHUNK = 256;
+
+    /// Nodo de la pila
+    struct Node{
+        T value;            ///< Valor
+        T maximum;          ///< Máximo desde este nodo hasta el fondo
+        Node * next;        ///< Nodo siguiente (hacia el fondo)
+    };
+
+    /// Estado de un hilo con un Handle
+    struct Record{
+        std::atomic<Node *> hazard;         ///< Nodo que está leyendo el hilo
+        std::atomic<bool> active;           ///< true si lo usa un Handle
+        Record * next_record;               ///< Registro siguiente
+        std::vector<Node *> retired;        ///< Nodos sacados que aún pueden estar leyéndose
+        std::vector<Node *> free_nodes;     ///< Nodos que se pueden reutilizar
+        char pad[CACHE_LINE];
+    };
+
+    std::atomic<Node *> top_node;           ///< Tope de la pila
+    char pad0[CACHE_LINE];
+    std::atomic<Record *> records;          ///< Lista de registros
+    std::atomic<size_t> record_count;       ///< Número de registros
+    std::mutex chunks_mutex;                ///< Protege chunks y spare
+    std::vector<Node *> chunks;             ///< Bloques de nodos reservados
+    std::vector<Node *> spare;              ///< Nodos libres de la reserva común
+
+    /**
+      * @brief Toma un registro libre o crea uno nuevo.
+      */
+    Record * acquire_record(){
+        for (Record * r = records.load(); r; r = r->next_record){
+            bool expected = false;
+            if (!r->active.load() && r->active.compare_exchange_strong(expected, true))
+                return r;
+        }
+        Record * r = new Record();
+        r->hazard.store(nullptr);
+        r->active.store(true);
+        Record * head = records.load();
+        do
+            r->next_record = head;
+        while (!records.compare_exchange_weak(head, r));
+        record_count.fetch_add(1);
+        return r;
+    }
+
+    /**
+      * @brief Nodo sin usar para el registro r.
+      */
+    Node * allocate(Record * r){
+        if (r->free_nodes.empty()){
+            std::lock_guard<std::mutex> lock(chunks_mutex);
+            if (spare.size() >= NODES_PER_CHUNK){
+                r->free_nodes.assign(spare.end() - NODES_PER_CHUNK, spare.end());
+                spare.resize(spare.size() - NODES_PER_CHUNK);
+            }
+            else{
+                Node * chunk = new Node[NODES_PER_CHUNK];
+                chunks.push_back(chunk);
+                for (size_t i = 0; i < NODES_PER_CHUNK; i++)
+                    r->free_nodes.push_back(chunk + i);
+            }
+        }
+        Node * n = r->free_nodes.back();
+        r->free_nodes.pop_back();
+        return n;
+    }
+
+    /**
+      * @brief Pasa a la lista de libres de r los nodos retirados que no lee ningún hilo.
+      */
+    void scan(Record * r){
+        std::vector<Node *> hazards;
+        for (Record * q = records.load(); q; q = q->next_record){
+            Node * h = q->hazard.load();
+            if (h)
+                hazards.push_back(h);
+        }
+        std::sort(hazards.begin(), hazards.end());
+
+        size_t kept = 0;
+        for (size_t i = 0; i < r->retired.size(); i++){
+            Node * n = r->retired[i];
+            if (std::binary_search(hazards.begin(), hazards.end(), n))
+                r->retired[kept++] = n;
+            else
+                r->free_nodes.push_back(n);
+        }
+        r->retired.resize(kept);
+
+        if (r->free_nodes.size() > 2 * NODES_PER_CHUNK){
+            std::lock_guard<std::mutex> lock(chunks_mutex);
+            spare.insert(spare.end(), r->free_nodes.end() - NODES_PER_CHUNK, r->free_nodes.end());
+            r->free_nodes.resize(r->free_nodes.size() - NODES_PER_CHUNK);
+        }
+    }
+
+    /**
+      * @brief Lee el tope y lo anuncia en el puntero de riesgo de r.
+      * @return El tope, que no se reutiliza hasta que se borre el puntero de riesgo.
+      */
+    Node * protect_top(Record * r){
+        Node * t = top_node.load();
+        for (;;){
+            r->hazard.store(t);
+            Node * again = top_node.load();
+            if (again == t)
+                return t;
+            t = again;
+        }
+    }
+
+public:
+
+    /**
+      * @brief Acceso de un hilo a la pila. Cada hilo usa el suyo.
+      */
+    class Handle{
+    private:
+
+        ConcurrentMaxStack & stack;         ///< Pila
+        Record * record;                    ///< Registro del hilo
+
+    public:
+
+        /**
+          * @brief Constructor. Toma un registro de la pila.
+          * @param s Pila. Tiene que existir mientras exista el Handle.
+          */
+        explicit Handle(ConcurrentMaxStack & s) : stack(s), record(s.acquire_record()) {}
+
+        /**
+          * @brief Destructor. Devuelve el registro a la pila.
+          */
+        ~Handle(){
+            record->hazard.store(nullptr);
+            stack.scan(record);
+            record->active.store(false);
+        }
+
+        Handle(const Handle &) = delete;
+        Handle & operator=(const Handle &) = delete;
+
+        /**
+          * @brief Inserta un valor en el tope de la pila.
+          * @param value Valor a insertar.
+          * @post Coste O(1) más los reintentos si otro hilo cambia el tope a la vez.
+          */
+        void push(const T & value){
+            Node * n = stack.allocate(record);
+            n->value = value;
+            for (;;){
+                Node * t = stack.protect_top(record);
+                n->next = t;
+                n->maximum = t && value < t->maximum ? t->maximum : value;
+                if (stack.top_node.compare_exchange_weak(t, n))
+                    break;
+            }
+            record->hazard.store(nullptr);
+        }
+
+        /**
+          * @brief Saca el valor del tope de la pila.
+          * @param value Valor sacado y máximo de la pila antes de sacarlo.
+          * @return false si la pila estaba vacía.
+          */
+        bool pop(Element & value){
+            Node * t;
+            for (;;){
+                t = stack.protect_top(record);
+                if (!t){
+                    record->hazard.store(nullptr);
+                    return false;
+                }
+                if (stack.top_node.compare_exchange_weak(t, t->next))
+                    break;
+            }
+            record->hazard.store(nullptr);
+            value = Element{t->value, t->maximum};
+
+            record->retired.push_back(t);
+            if (record->retired.size() >= 2 * stack.record_count.load() + 32)
+                stack.scan(record);
+            return true;
+        }
+
+        /**
+          * @brief Saca el valor del tope de la pila.
+          * @return false si la pila estaba vacía.
+          */
+        bool pop(){
+            Element discarded;
+            return pop(discarded);
+        }
+
+        /**
+          * @brief Consulta el tope de la pila.
+          * @param value Valor del tope y máximo de la pila.
+          * @return false si la pila está vacía.
+          */
+        bool top(Element & value){
+            Node * t = stack.protect_top(record);
+            if (t)
+                value = Element{t->value, t->maximum};
+            record->hazard.store(nullptr);
+            return t != nullptr;
+        }
+    };
+
+    /**
+      * @brief Constructor. La pila está vacía.
+      */
+    ConcurrentMaxStack() : top_node(nullptr), records(nullptr), record_count(0) {}
+
+    /**
+      * @brief Destructor. Libera todos los nodos y registros.
+      * @pre No queda ningún Handle de la pila.
+      */
+    ~ConcurrentMaxStack(){
+        for (size_t i = 0; i < chunks.size(); i++)
+            delete [] chunks[i];
+        Record * r = records.load();
+        while (r){
+            Record * next = r->next_record;
+            delete r;
+            r = next;
+        }
+    }
+
+    ConcurrentMaxStack(const ConcurrentMaxStack &) = delete;
+    ConcurrentMaxStack & operator=(const ConcurrentMaxStack &) = delete;
+
+    /**
+      * @brief Indica si la pila está vacía (en el momento de la llamada).
+      */
+    bool empty() const { return top_node.load() == nullptr; }
+};
+
+#endif // _CONCURRENT_MAX_STACK_H_
@@ -5,9 +5,11 @@
  * @author Andrés Gutiérrez Armenteros
  */
 
-#include <stack>
 #include <iostream>
 
+#include "slidingaggregate.h"
+#include "compactaggregate.h"
+
 struct element{
 
     int value;
@@ -24,9 +26,7 @@ struct element{
 
   así como el valor del máximo  almacenado en la cola en cada momento.
 
-  La implementación interna hace uso de pilas.
-
-  El TDA MaxQueue proporciona además distintas herramientas para la manipulación de dichas colas.
+  Es la cola SlidingAggregate con la operación máximo: push, pop, front, size y empty tienen coste O(1) en el peor caso.
 
   Para poder usar el TDA MaxQueue se debe incluir el fichero
 
@@ -36,74 +36,18 @@ struct element{
   @author Andrés Gutiérrez Armenteros
 
 **/
+typedef SlidingAggregate<int, MaxOf<int>, element> MaxQueue;
 
-class MaxQueue{
-    /**
-     @page page_repMaxQueue Representación de MaxQueue
-
-     @section sec_Max_Queue MaxQueue
-
-     El **TDA MaxQueue** se corresponde con una cola de _elements_ donde se almacenan valores siguiendo la jerarquía **FIFO** (_First In first Out_) donde los elementos se almacenan de manera que se insertan por el final de la cola y se acceden por el frente. El último elemento en añadirse será el último al que se acceda por el frente de la cola. Al momento de acceder a un valor se indicará también el valor máximo de la cola en ese momento.
-
-   **/
-private:
-
-    /**
-      @brief Pila principal (Pila cuyos elementos son miembros del struct "element")
-
-      los elementos de pila son miembros del struct "element" (con dos campos: value y max)
-
-    **/
-    std::stack<element> pila;
-
-public:
-
-    //******************
-    // Métodos básicos:
-    //
-    // No es necesario declararlos (se llama a los metodos por defecto de la clase <stack>)
-    //
-    //MaxQueue(){};
-    //MaxQueue(MaxQueue &other){};
-    //~MaxQueue(){};
-    //******************
-
-    /**
-      * @brief Añade un elemento nuevo a la cola (y actualiza el maximo).
-      * @param new_value Nuevo valor (entero) a añadir.
-      * @post La cola se modifica.
-      */
-    void push(int new_value);
-
-    /**
-      * @brief Elimina un elemento de la cola (y actualiza el maximo).
-      * @post La cola se modifica.
-      */
-    void pop();
-
-    //***************
-    // Metodos inline
-    //***************
-
-    /**
-      * @brief Accede al elemento en el frente de la cola
-      * @post La cola no se modifica.
-      * @return El elemento (miembro del struct element) al frente de la cola.
-      */
-    element front(){ return(this->pila.top()); };
-
-    /**
-      * @brief Devuelve el tamaño actual de la cola (numero de elementos).
-      * @post La cola no se modifica.
-      * @return El tamaño (entero).
-      */
-    int size(){ return(this->pila.size()); };
-
-    /**
-      * @brief Comprueba si la cola esta o no vacia.
-      * @post La cola no se modifica.
-      * @return true si la cola esta vacia, false en caso contrario (booleano).
-      */
-    bool empty(){ return(this->pila.empty()); };
+/**
+  @brief T.D.A. CompactMaxQueue
 
-};
+  Cola de enteros con máximo, con la misma interfaz que MaxQueue, que guarda los valores
+  seguidos y un tramo (máximo, número de elementos) por cada cambio del máximo en cada
+  una de sus dos pilas (ver CompactSlidingAggregate). Cuando el máximo cambia pocas veces
+  ocupa casi la mitad que MaxQueue, pero push y pop tienen coste O(1) amortizado en
+  lugar de en el peor caso.
+
+  \#include <maxqueue.h>
+
+**/
+typedef CompactSlidingAggregate<int, MaxOf<int>, element> CompactMaxQueue;
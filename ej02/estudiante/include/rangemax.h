@@ -0,0 +1,115 @@
+/**
+ * @file rangemax.h
+ * @brief  Archivo de especificación del TDA RangeMax y del máximo de ventana fija sobre vectores
+ * @author Pablo García Bas
+ * @author Andrés Gutiérrez Armenteros
+ */
+
+#ifndef _RANGE_MAX_H_
+#define _RANGE_MAX_H_
+
+#include <vector>
+
+#include "slidingaggregate.h"
+
+/**
+  @brief T.D.A. RangeMax
+
+  Una instancia del tipo de dato abstracto RangeMax es un índice sobre un vector de
+  enteros fijo que responde en O(1) al máximo de cualquier intervalo [first, last)
+  (tabla dispersa, _sparse table_). Construirlo cuesta O(n log n) en tiempo y en
+  memoria: n * (log2(n) + 1) enteros, p.e. unos 84 MB para un millón de valores.
+
+  Para recorrer un flujo con una ventana deslizante es mejor MaxQueue, y para el
+  máximo de todas las ventanas de un tamaño fijo de un vector, WindowMax().
+
+  \code
+  RangeMax index(data, n);
+  AggregateElement<int> e = index.Query(10, 20);      // e.value = data[10], e.aggregate = máximo de data[10..19]
+  \endcode
+
+  \#include <rangemax.h>
+
+  @author Andrés Gutiérrez
+  @author Pablo García
+
+**/
+class RangeMax{
+    /**
+     @page page_repRangeMax Representación de RangeMax
+
+     @section sec_Range_Max RangeMax
+
+     table tiene un nivel de n enteros por cada potencia de dos 2^k <= n: table[k*n + i] es el máximo de los 2^k valores que empiezan en i (sólo para i + 2^k <= n). El nivel 0 es una copia de los datos, y cada nivel se calcula a partir del anterior como el máximo de dos mitades. El máximo de [first, last) es el mayor entre los de los dos intervalos de longitud 2^k, con 2^k la mayor potencia de dos que no supera last - first, que empiezan en first y terminan en last.
+
+   **/
+private:
+
+    int n;                      ///< Número de valores
+    std::vector<int> table;     ///< Máximos de los intervalos de longitud potencia de dos, por niveles
+
+public:
+
+    /**
+      * @brief Constructor por defecto. Índice vacío.
+      */
+    RangeMax();
+
+    /**
+      * @brief Constructor. Construye el índice de un vector (ver Build()).
+      * @param data Valores.
+      * @param size Número de valores.
+      */
+    RangeMax(const int * data, int size);
+
+    /**
+      * @brief Construye el índice de un vector, que no se vuelve a consultar después.
+      * @param data Valores.
+      * @param size Número de valores.
+      * @pre size >= 0
+      */
+    void Build(const int * data, int size);
+
+    /**
+      * @brief Máximo de un intervalo.
+      * @param first Primera posición.
+      * @param last Posición siguiente a la última.
+      * @pre 0 <= first < last <= size()
+      * @return El máximo de los valores de [first, last). Coste O(1).
+      */
+    int Max(int first, int last) const;
+
+    /**
+      * @brief Consulta un intervalo como si fuera una cola con máximo.
+      * @param first Primera posición.
+      * @param last Posición siguiente a la última.
+      * @pre 0 <= first < last <= size()
+      * @return El valor de first (el frente) y el máximo de [first, last). Coste O(1).
+      */
+    AggregateElement<int> Query(int first, int last) const;
+
+    /**
+      * @brief Número de valores del índice.
+      */
+    int size() const { return n; }
+};
+
+/**
+  * @brief Máximo de todas las ventanas de tamaño fijo de un vector (van Herk / Gil-Werman).
+  *
+  * Divide los datos en bloques de window valores y calcula en cada bloque el máximo
+  * acumulado de izquierda a derecha y de derecha a izquierda. Cada ventana abarca el
+  * final de un bloque y el principio del siguiente (o un bloque entero), así que su
+  * máximo es el mayor de esos dos acumulados. Son unas 3 comparaciones por valor,
+  * sea cual sea el tamaño de la ventana.
+  *
+  * @param data Valores.
+  * @param size Número de valores.
+  * @param window Tamaño de la ventana.
+  * @param out Resultado: out[i] es el máximo de data[i .. i+window-1], para i de 0 a
+  * size - window. Tiene que tener sitio para size - window + 1 enteros.
+  * @pre 1 <= window <= size
+  */
+void WindowMax(const int * data, int size, int window, int * out);
+
+#endif // _RANGE_MAX_H_
@@ -0,0 +1,220 @@
+/**
+ * @file ringbuffer.h
+ * @brief  Archivo de especificación del TDA RingBuffer
+ * @author Pablo García Bas
+ * @author Andrés Gutiérrez Armenteros
+ */
+
+#ifndef _RING_BUFFER_H_
+#define _RING_BUFFER_H_
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+  @brief T.D.A. RingBuffer
+
+  Una instancia del tipo de dato abstracto RingBuffer es una secuencia de elementos de
+  tipo T en un buffer circular contiguo, con inserción al final y borrado por los dos
+  extremos en O(1). Es el almacenamiento de SlidingAggregate y AggregateStack.
+
+  - Con Capacity == 0 (por defecto) el buffer crece: cuando está lleno, se duplica y se
+  copian los elementos (O(n)). Nunca se reduce, así que después de alcanzar su tamaño
+  máximo (o de llamar a reserve()) no vuelve a reservar memoria.
+
+  - Con Capacity > 0 (potencia de dos) el buffer es un array de Capacity elementos
+  dentro del propio objeto: nunca reserva memoria y push_back tiene coste O(1) en el
+  peor caso, pero no puede tener más de Capacity elementos.
+
+  \#include <ringbuffer.h>
+
+  @author Andrés Gutiérrez
+  @author Pablo García
+
+**/
+template <typename T, size_t Capacity = 0>
+class RingBuffer{
+    /**
+     @page page_repRingBuffer Representación de RingBuffer
+
+     @section sec_Ring_Buffer RingBuffer
+
+     Los elementos están en un vector (o un array, si la capacidad es fija) cuyo tamaño es una potencia de dos. El elemento i-ésimo, contando desde el frente, está en la posición (head + i) & mask, con mask = capacidad - 1, así que los índices dan la vuelta al llegar al final sin divisiones. Cada elemento ocupa sizeof(T) bytes seguidos: en SlidingAggregate<int, ...> son pares {value, aggregate} de 8 bytes, 8 por línea de caché de 64 bytes.
+
+     Al crecer, los elementos se copian en orden a un vector del doble de tamaño y head vuelve a 0.
+
+   **/
+    static_assert((Capacity & (Capacity - 1)) == 0, "RingBuffer: la capacidad debe ser potencia de dos");
+
+private:
+
+    typedef typename std::conditional<Capacity == 0, std::vector<T>, std::array<T, Capacity> >::type Storage;
+
+    enum { INITIAL_CAPACITY = 16 };     ///< Capacidad inicial de un buffer que crece
+
+    Storage buf;        ///< Elementos; su tamaño es la capacidad
+    size_t head;        ///< Posición del frente
+    size_t count;       ///< Número de elementos
+
+    size_t mask() const { return buf.size() - 1; }
+
+    // Cambia la capacidad de un buffer que crece (la nueva es potencia de dos y cabe todo)
+    static void Resize(std::vector<T> & storage, size_t & first, size_t n, size_t new_capacity){
+        std::vector<T> bigger(new_capacity);
+        for (size_t i = 0; i < n; i++)
+            bigger[i] = std::move(storage[(first + i) & (storage.size() - 1)]);
+        storage.swap(bigger);
+        first = 0;
+    }
+
+    // Un buffer de capacidad fija no puede crecer
+    static void Resize(std::array<T, Capacity> &, size_t &, size_t, size_t){
+        assert(false && "RingBuffer: capacidad fija superada");
+    }
+
+public:
+
+    /**
+      * @brief Constructor. El buffer está vacío.
+      */
+    RingBuffer() : buf(), head(0), count(0) {}
+
+    /**
+      * @brief Reserva espacio para que quepan al menos n elementos sin volver a reservar memoria.
+      * @param n Número de elementos.
+      * @pre Si la capacidad es fija, n <= Capacity.
+      * @exception std::length_error si ninguna potencia de dos representable llega a n.
+      */
+    void reserve(size_t n){
+        if (n <= buf.size())
+            return;
+        size_t capacity = INITIAL_CAPACITY;
+        while (capacity < n && capacity <= std::numeric_limits<size_t>::max() / 2)
+            capacity *= 2;
+        if (capacity < n)
+            throw std::length_error("RingBuffer::reserve");
+        Resize(buf, head, count, capacity);
+    }
+
+    /**
+      * @brief Añade un elemento al final.
+      * @param value Elemento a añadir.
+      * @pre Si la capacidad es fija, size() < Capacity.
+      * @post Coste O(1) (amortizado si el buffer tiene que crecer).
+      */
+    void push_back(const T & value){
+        if (count == buf.size())
+            Resize(buf, head, count, buf.empty() ? (size_t)INITIAL_CAPACITY : 2 * buf.size());
+        buf[(head + count) & mask()] = value;
+        count++;
+    }
+
+    /**
+      * @brief Huecos libres seguidos al final del buffer, para escribir varios elementos a la vez.
+      *
+      * Si el buffer está lleno, crece como en push_back(). Los elementos escritos en los
+      * huecos pasan a formar parte del buffer al llamar a commit_back().
+      *
+      * @param n Número de huecos que se quieren. Se reduce a los que hay seguidos (al menos 1).
+      * @pre Si la capacidad es fija, size() < Capacity.
+      * @return Puntero al primer hueco.
+      */
+    T * back_slots(size_t & n){
+        if (count == buf.size())
+            Resize(buf, head, count, buf.empty() ? (size_t)INITIAL_CAPACITY : 2 * buf.size());
+        size_t pos = (head + count) & mask();
+        n = std::min(n, std::min(buf.size() - count, buf.size() - pos));
+        return &buf[pos];
+    }
+
+    /**
+      * @brief Añade al final los n elementos escritos en los huecos de back_slots().
+      * @param n Número de elementos.
+      * @pre n no es mayor que el número de huecos que devolvió back_slots().
+      */
+    void commit_back(size_t n){ count += n; }
+
+    /**
+      * @brief Elimina el primer elemento.
+      * @pre El buffer no está vacío.
+      */
+    void pop_front(){
+        head = (head + 1) & mask();
+        count--;
+    }
+
+    /**
+      * @brief Elimina el último elemento.
+      * @pre El buffer no está vacío.
+      */
+    void pop_back(){ count--; }
+
+    /**
+      * @brief Elimina los n primeros elementos.
+      * @pre n <= size()
+      */
+    void pop_front_n(size_t n){
+        head = (head + n) & mask();
+        count -= n;
+    }
+
+    /**
+      * @brief Elimina los n últimos elementos.
+      * @pre n <= size()
+      */
+    void pop_back_n(size_t n){ count -= n; }
+
+    /**
+      * @brief Elimina todos los elementos (conserva la capacidad).
+      */
+    void clear(){
+        head = 0;
+        count = 0;
+    }
+
+    /**
+      * @brief Elemento i-ésimo, contando desde el frente.
+      * @param i Posición.
+      * @pre 0 <= i < size()
+      */
+    T & operator[](size_t i){ return buf[(head + i) & mask()]; }
+    const T & operator[](size_t i) const { return buf[(head + i) & mask()]; }
+
+    /**
+      * @brief Primer elemento.
+      * @pre El buffer no está vacío.
+      */
+    T & front(){ return buf[head]; }
+    const T & front() const { return buf[head]; }
+
+    /**
+      * @brief Último elemento.
+      * @pre El buffer no está vacío.
+      */
+    T & back(){ return buf[(head + count - 1) & mask()]; }
+    const T & back() const { return buf[(head + count - 1) & mask()]; }
+
+    /**
+      * @brief Número de elementos.
+      */
+    size_t size() const { return count; }
+
+    /**
+      * @brief Indica si el buffer está vacío.
+      */
+    bool empty() const { return count == 0; }
+
+    /**
+      * @brief Número de elementos que caben sin reservar memoria.
+      */
+    size_t capacity() const { return buf.size(); }
+};
+
+#endif // _RING_BUFFER_H_
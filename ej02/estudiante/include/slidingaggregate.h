@@ -0,0 +1,452 @@
+/**
+ * @file slidingaggregate.h
+ * @brief  Archivo de especificación de los TDA SlidingAggregate y AggregateStack
+ * @author Pablo García Bas
+ * @author Andrés Gutiérrez Armenteros
+ */
+
+#ifndef _SLIDING_AGGREGATE_H_
+#define _SLIDING_AGGREGATE_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+#include "ringbuffer.h"
+
+/**
+  @brief Tipo AggregateElement
+
+  Par formado por un valor y el agregado del contenedor en el momento de acceder a él.
+  Es el tipo que devuelven por defecto SlidingAggregate::front() y AggregateStack::top().
+
+**/
+template <typename T>
+struct AggregateElement{
+    T value;        ///< Valor del elemento
+    T aggregate;    ///< Agregado del contenedor
+};
+
+/**
+  @brief Operaciones de agregación habituales.
+
+  Una operación es un objeto función que combina dos valores, @c op(a,b), y que debe
+  ser asociativa: @c op(op(a,b),c) == @c op(a,op(b,c)). No hace falta que sea
+  conmutativa ni que tenga elemento neutro.
+
+**/
+template <typename T>
+struct MaxOf{
+    T operator()(const T & a, const T & b) const { return a < b ? b : a; }
+};
+
+/// Mínimo
+template <typename T>
+struct MinOf{
+    T operator()(const T & a, const T & b) const { return b < a ? b : a; }
+};
+
+/// Suma
+template <typename T>
+struct SumOf{
+    T operator()(const T & a, const T & b) const { return a + b; }
+};
+
+/// Máximo común divisor (de enteros no negativos)
+template <typename T>
+struct GcdOf{
+    T operator()(T a, T b) const {
+        while (b != 0){
+            T r = a % b;
+            a = b;
+            b = r;
+        }
+        return a;
+    }
+};
+
+/// O a nivel de bits
+template <typename T>
+struct OrOf{
+    T operator()(const T & a, const T & b) const { return a | b; }
+};
+
+/**
+  @brief Posición del máximo: los valores son pares (valor, posición), y a igual
+  valor gana el más antiguo (el de la izquierda).
+**/
+template <typename V, typename I = long>
+struct ArgMaxOf{
+    std::pair<V, I> operator()(const std::pair<V, I> & a, const std::pair<V, I> & b) const {
+        return a.first < b.first ? b : a;
+    }
+};
+
+/**
+  @brief T.D.A. AggregateStack
+
+  Una instancia del tipo de dato abstracto AggregateStack es una pila LIFO de valores de
+  tipo T que conoce en todo momento el agregado (con la operación asociativa Op) de todos
+  sus elementos, del fondo al tope. Guarda el agregado junto a cada elemento; MaxStack
+  es en cambio un CompactAggregateStack, que lo guarda por tramos.
+
+  Los elementos se guardan en un RingBuffer. Con Capacity == 0 (por defecto) la pila
+  crece sin límite y push tiene coste O(1) amortizado; con Capacity > 0 (potencia de dos)
+  no reserva memoria nunca, todas las operaciones tienen coste O(1) en el peor caso y
+  caben como mucho Capacity elementos.
+
+  \#include <slidingaggregate.h>
+
+  @author Andrés Gutiérrez
+  @author Pablo García
+
+**/
+template <typename T, typename Op, typename Element = AggregateElement<T>, size_t Capacity = 0>
+class AggregateStack{
+    /**
+     @page page_repAggregateStack Representación de AggregateStack
+
+     @section sec_Aggregate_Stack AggregateStack
+
+     Los elementos se guardan en un RingBuffer de pares {value, aggregate}, seguidos en memoria, con el fondo de la pila en la posición 0 y el tope en la última. Junto a cada valor se guarda el agregado de ese valor y de todos los que tiene debajo, así que el del tope es el agregado de la pila.
+
+   **/
+private:
+
+    RingBuffer<AggregateElement<T>, Capacity> v;    ///< Valores y agregados desde el fondo, con el tope al final
+    Op op;                                  ///< Operación de agregación
+
+public:
+
+    /**
+      * @brief Constructor.
+      * @param operation Operación de agregación. Por defecto, Op().
+      */
+    explicit AggregateStack(const Op & operation = Op()) : op(operation) {}
+
+    /**
+      * @brief Inserta un valor en el tope de la pila.
+      * @param val Valor a insertar.
+      * @pre Si la capacidad es fija, size() < Capacity.
+      * @post El elemento se inserta junto con el agregado de la pila. Coste O(1) (amortizado si la pila tiene que crecer).
+      */
+    void push(const T & val){
+        AggregateElement<T> e = {val, v.empty() ? val : op(v.back().aggregate, val)};
+        v.push_back(e);
+    }
+
+    /**
+      * @brief Elimina el elemento del _tope_ de la pila.
+      * @post La pila pasa a tener un elemento menos (si estaba vacía, no se modifica). Coste O(1).
+      */
+    void pop(){
+        if (!v.empty())
+            v.pop_back();
+    }
+
+    /**
+      * @brief Muestra el elemento del _tope_ de la pila.
+      * @pre pila no vacía.
+      * @return El valor del tope y el agregado de la pila.
+      */
+    Element top() const { return Element{v.back().value, v.back().aggregate}; }
+
+    /**
+      * @brief Agregado de todos los elementos de la pila.
+      * @pre pila no vacía.
+      * @return op(fondo, ..., tope).
+      */
+    T aggregate() const { return v.back().aggregate; }
+
+    /**
+      * @brief Reserva espacio para que quepan n elementos sin volver a reservar memoria.
+      * @param n Número de elementos.
+      * @pre Si la capacidad es fija, n <= Capacity.
+      */
+    void reserve(size_t n){ v.reserve(n); }
+
+    /**
+      * @brief Indica si la pila está o no vacía.
+      * @return true si la pila está vacía.
+      */
+    bool empty() const { return v.empty(); }
+
+    /**
+      * @brief Indica el número de elementos que hay actualmente en la pila.
+      * @return Número de elementos.
+      */
+    int size() const { return v.size(); }
+};
+
+/**
+  @brief T.D.A. SlidingAggregate
+
+  Una instancia del tipo de dato abstracto SlidingAggregate es una cola FIFO de valores
+  de tipo T que conoce en todo momento el agregado (con la operación asociativa Op) de
+  todos sus elementos, del frente al final. Sirve para calcular el máximo, el mínimo, la
+  suma... de una ventana deslizante: se inserta cada valor nuevo con push() y se elimina
+  el más antiguo con pop(). MaxQueue es SlidingAggregate<int, MaxOf<int>, element>.
+
+  Todas las operaciones aplican la operación como mucho tres veces. Los elementos se
+  guardan en un RingBuffer: con Capacity == 0 (por defecto) la cola crece sin límite y
+  push tiene coste O(1) salvo cuando el buffer se duplica (ver reserve()); con
+  Capacity > 0 (potencia de dos) no reserva memoria nunca y todas las operaciones
+  tienen coste O(1) en el peor caso. Para una ventana de w elementos en la que se
+  inserta antes de sacar, hace falta capacidad para w+1.
+
+  \code
+  SlidingAggregate<int, MinOf<int> > window;
+  for (int k = 0; k < n; k++){
+      window.push(sample[k]);
+      if (window.size() > w)
+          window.pop();
+      minimum[k] = window.aggregate();
+  }
+  \endcode
+
+  \#include <slidingaggregate.h>
+
+  @author Andrés Gutiérrez
+  @author Pablo García
+
+**/
+template <typename T, typename Op, typename Element = AggregateElement<T>, size_t Capacity = 0>
+class SlidingAggregate{
+    /**
+     @page page_repSlidingAggregate Representación de SlidingAggregate
+
+     @section sec_Sliding_Aggregate SlidingAggregate
+
+     Es la técnica de las dos pilas (una de salida, con el agregado de cada elemento hasta el final de la pila, y otra de entrada, con el agregado desde su principio) sin la inversión de la pila de entrada de golpe, que cuesta O(n). En su lugar, la inversión se reparte en un paso por operación (como el algoritmo DABA, _De-Amortized Banker's Aggregator_).
+
+     Todos los elementos están en un RingBuffer, del frente al final, como pares {value, aggregate} seguidos en memoria: _value_ es el valor y _aggregate_ un agregado parcial. Los índices l <= r <= a <= b lo dividen en tramos:
+
+     - [0, l): salida corregida. Agregado desde el elemento hasta b-1.
+     - [l, r): salida antigua. Agregado desde el elemento hasta r-1; falta combinarlo con x, el agregado de [r, b).
+     - [r, a): entrada antigua aún sin invertir. Agregado desde r hasta el elemento.
+     - [a, b): entrada antigua ya invertida. Agregado desde el elemento hasta b-1.
+     - [b, final): entrada. Agregado desde b hasta el elemento.
+
+     Mientras no hay inversión en curso, l = r = a = b y la salida es [0, b). Cuando la entrada pasa a tener más elementos que la salida, empieza una inversión: la salida pasa a ser la salida antigua, la entrada pasa a ser la entrada antigua, y la nueva entrada queda vacía. Cada operación da un paso: invierte un elemento de [r, a) y corrige uno de [l, r). Como al empezar la entrada tiene un elemento más que la salida, la inversión termina antes de que se saque toda la salida antigua (así que si r == 0, también a == 0) y antes de que la nueva entrada supere a la salida.
+
+   **/
+private:
+
+    RingBuffer<AggregateElement<T>, Capacity> d;    ///< Valores y agregados parciales, del frente al final
+    size_t l, r, a, b;                      ///< Límites de los tramos
+    T x;                                    ///< Agregado de [r, b) durante una inversión
+    Op op;                                  ///< Operación de agregación
+
+    /**
+      * @brief Agregado de la salida [0, b).
+      * @pre b > 0
+      */
+    T front_aggregate() const {
+        if (l == 0 && r > 0)
+            return op(d.front().aggregate, x);
+        return d.front().aggregate;
+    }
+
+    /**
+      * @brief Da k pasos de la inversión en curso.
+      * @pre k no es mayor que los pasos que le quedan, max(a - r, r - l).
+      */
+    void advance(size_t k){
+        for (size_t j = std::min(k, a - r); j > 0; j--){
+            --a;
+            d[a].aggregate = a + 1 < b ? op(d[a].value, d[a+1].aggregate) : d[a].value;
+        }
+        for (size_t j = std::min(k, r - l); j > 0; j--){
+            d[l].aggregate = op(d[l].aggregate, x);
+            ++l;
+        }
+        if (l == r && a == r)
+            l = r = a = b;
+    }
+
+    /**
+      * @brief Empieza una inversión si hace falta y da un paso de la que esté en curso.
+      */
+    void fixup(){
+        if (l == r && a == r){
+            if (d.size() - b <= b)
+                return;
+            // La entrada tiene más elementos que la salida: empieza la inversión
+            x = d.back().aggregate;
+            l = 0;
+            r = b;
+            a = b = d.size();
+        }
+        advance(1);
+    }
+
+public:
+
+    /**
+      * @brief Constructor.
+      * @param operation Operación de agregación. Por defecto, Op().
+      */
+    explicit SlidingAggregate(const Op & operation = Op()) : l(0), r(0), a(0), b(0), x(), op(operation) {}
+
+    /**
+      * @brief Añade un valor al final de la cola.
+      * @param new_value Valor a añadir.
+      * @pre Si la capacidad es fija, size() < Capacity.
+      * @post La cola se modifica. Coste O(1) (amortizado si la cola tiene que crecer).
+      */
+    void push(const T & new_value){
+        AggregateElement<T> e = {new_value, d.size() > b ? op(d.back().aggregate, new_value) : new_value};
+        d.push_back(e);
+        fixup();
+    }
+
+    /**
+      * @brief Elimina el elemento del frente de la cola.
+      * @pre La cola no está vacía.
+      * @post La cola se modifica. Coste O(1).
+      */
+    void pop(){
+        d.pop_front();
+        if (l > 0) --l;
+        if (r > 0) --r;
+        if (a > 0) --a;
+        --b;
+        fixup();
+    }
+
+    /**
+      * @brief Añade al final de la cola los valores de [first, last), en orden.
+      *
+      * Hace lo mismo que push() con cada valor, pero por tandas: escribe seguidos en
+      * el buffer los valores, con su agregado acumulado, hasta el final de la inversión
+      * en curso (y después da todos sus pasos de una vez, que no tocan la entrada) o,
+      * si no hay ninguna, hasta que tenga que empezar otra.
+      *
+      * @param first Primer valor.
+      * @param last Fin de los valores.
+      * @post La cola se modifica. Coste O(1) amortizado por valor.
+      */
+    template <typename InputIt>
+    void push_range(InputIt first, InputIt last){
+        while (first != last){
+            // Con una inversión en curso, se pueden insertar tantos como pasos le quedan; sin
+            // ninguna, hasta que la entrada iguale a la salida
+            bool flipping = l < r || a > r;
+            size_t room = flipping ? std::max(a - r, r - l) : b - (d.size() - b);
+            if (room == 0){
+                push(*first);
+                ++first;
+                continue;
+            }
+
+            bool back_empty = d.size() == b;
+            T aggregate = back_empty ? T() : d.back().aggregate;
+            AggregateElement<T> * slot = d.back_slots(room);
+            size_t k = 0;
+            for (; k < room && first != last; ++k, ++first){
+                const T & v = *first;
+                aggregate = back_empty && k == 0 ? v : op(aggregate, v);
+                slot[k].value = v;
+                slot[k].aggregate = aggregate;
+            }
+            d.commit_back(k);
+            if (flipping)
+                advance(k);
+        }
+    }
+
+    /**
+      * @brief Elimina los n elementos del frente de la cola.
+      *
+      * Hace lo mismo que pop() n veces, pero por tandas: quita de una vez los que
+      * puede sacar de la salida antigua antes del final de la inversión en curso (y
+      * después da esos pasos) o, si no hay ninguna, los que puede sacar antes de que
+      * tenga que empezar otra.
+      *
+      * @param n Número de elementos. Si es mayor que size(), se vacía la cola,
+      * como en CompactAggregateStack::pop_n.
+      * @post La cola se modifica. Coste O(1) amortizado por elemento.
+      */
+    void pop_n(int n){
+        n = std::min(std::max(n, 0), size());
+        while (n > 0){
+            if (l < r || a > r){
+                // Con una inversión en curso, se pueden sacar de la salida antigua tantos
+                // como pasos le quedan, y dar después esos pasos
+                size_t k = std::min((size_t)n, std::min(r, std::max(a - r, r - l)));
+                d.pop_front_n(k);
+                l -= std::min(l, k);
+                r -= k;
+                a -= k;
+                b -= k;
+                advance(k);
+                n -= k;
+                continue;
+            }
+
+            // Sin ninguna, se puede sacar hasta que la salida iguale a la entrada
+            size_t k = std::min((size_t)n, b - (d.size() - b));
+            if (k == 0){
+                pop();
+                n--;
+                continue;
+            }
+            d.pop_front_n(k);
+            l = r = a = b = b - k;
+            n -= k;
+        }
+    }
+
+    /**
+      * @brief Copia los valores de los n primeros elementos, desde el frente.
+      * @param n Número de elementos.
+      * @param out Destino de los valores.
+      * @pre 0 <= n <= size()
+      * @return out después del último valor copiado. Coste O(n).
+      */
+    template <typename OutputIt>
+    OutputIt front_n(int n, OutputIt out) const {
+        for (int i = 0; i < n; i++, ++out)
+            *out = d[i].value;
+        return out;
+    }
+
+    /**
+      * @brief Accede al elemento en el frente de la cola.
+      * @pre La cola no está vacía.
+      * @return El valor del frente y el agregado de toda la cola.
+      */
+    Element front() const { return Element{d.front().value, aggregate()}; }
+
+    /**
+      * @brief Agregado de todos los elementos de la cola.
+      * @pre La cola no está vacía.
+      * @return op(frente, ..., final).
+      */
+    T aggregate() const {
+        if (d.size() == b)
+            return front_aggregate();
+        return op(front_aggregate(), d.back().aggregate);
+    }
+
+    /**
+      * @brief Reserva espacio para que quepan n elementos sin volver a reservar memoria.
+      * @param n Número de elementos.
+      * @pre Si la capacidad es fija, n <= Capacity.
+      */
+    void reserve(size_t n){ d.reserve(n); }
+
+    /**
+      * @brief Devuelve el tamaño actual de la cola (numero de elementos).
+      * @return El tamaño (entero).
+      */
+    int size() const { return d.size(); }
+
+    /**
+      * @brief Comprueba si la cola esta o no vacia.
+      * @return true si la cola esta vacia.
+      */
+    bool empty() const { return d.empty(); }
+};
+
+#endif // _SLIDING_AGGREGATE_H_
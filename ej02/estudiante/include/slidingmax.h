@@ -0,0 +1,172 @@
+/**
+ * @file slidingmax.h
+ * @brief  Archivo de especificación del máximo de ventana deslizante sobre flujos de enteros
+ * @author Pablo García Bas
+ * @author Andrés Gutiérrez Armenteros
+ */
+
+#ifndef _SLIDING_MAX_H_
+#define _SLIDING_MAX_H_
+
+#include <cstdio>
+
+#include "maxqueue.h"
+
+/**
+  @brief Resultado de procesar un flujo con SlidingMaxStream().
+**/
+enum StreamResult{
+    STREAM_OK,              ///< Se ha procesado todo el flujo
+    STREAM_BAD_VALUE,       ///< Hay un valor que no es un entero (o no cabe en un int)
+    STREAM_WRITE_ERROR      ///< No se pudo escribir el resultado
+};
+
+/**
+  @brief Lector rápido de enteros de un FILE.
+
+  Lee el fichero por bloques y convierte los enteros a mano, sin pasar cada valor
+  por iostream ni por scanf. Los valores son enteros en decimal, con signo opcional,
+  separados por espacios en blanco (espacios, tabuladores o saltos de línea).
+
+**/
+class IntReader{
+private:
+
+    static const int BUFFER_SIZE = 1 << 16;
+
+    FILE * in;                  ///< Fichero del que se lee
+    char buffer[BUFFER_SIZE];   ///< Bloque leído
+    const char * pos;           ///< Siguiente carácter por leer de buffer
+    const char * end;           ///< Fin de los datos de buffer
+    bool bad;                   ///< true si se ha encontrado un valor no válido
+
+    /**
+      * @brief Lee el siguiente bloque.
+      * @return false si no queda nada por leer.
+      */
+    bool Refill();
+
+public:
+
+    /**
+      * @brief Constructor.
+      * @param file Fichero abierto para lectura.
+      */
+    explicit IntReader(FILE * file);
+
+    /**
+      * @brief Lee el siguiente entero.
+      * @param value Entero leído.
+      * @return false al llegar al final del fichero o si el siguiente valor no es válido (ver error()).
+      */
+    bool Next(int & value);
+
+    /**
+      * @brief Indica si la lectura se paró por un valor no válido.
+      * @return true si Next() encontró un valor que no es un entero o no cabe en un int.
+      */
+    bool error() const { return bad; }
+};
+
+/**
+  @brief Escritor rápido de enteros en un FILE, uno por línea.
+**/
+class IntWriter{
+private:
+
+    static const int BUFFER_SIZE = 1 << 16;
+
+    FILE * out;                 ///< Fichero en el que se escribe
+    char buffer[BUFFER_SIZE];   ///< Bloque por escribir
+    int used;                   ///< Caracteres ocupados de buffer
+    bool bad;                   ///< true si ha fallado alguna escritura
+
+public:
+
+    /**
+      * @brief Constructor.
+      * @param file Fichero abierto para escritura.
+      */
+    explicit IntWriter(FILE * file) : out(file), used(0), bad(false) {}
+
+    /**
+      * @brief Destructor. Escribe lo que quede en el bloque.
+      */
+    ~IntWriter() { Flush(); }
+
+    /**
+      * @brief Escribe un entero seguido de un salto de línea.
+      * @param value Entero a escribir.
+      */
+    void Put(int value);
+
+    /**
+      * @brief Escribe el bloque en el fichero.
+      * @return false si ha fallado alguna escritura.
+      */
+    bool Flush();
+};
+
+/**
+  @brief Máximo de una ventana deslizante.
+
+  Recibe los valores de uno en uno y devuelve el máximo de los window últimos (o de
+  todos, mientras haya menos de window). Usa una MaxQueue con espacio reservado para
+  la ventana desde el constructor, así que cada valor cuesta O(1) en el peor caso y no
+  se reserva memoria al procesarlo. Con ventanas de más de 65535 valores sólo se
+  reserva espacio para 65536 (la ventana puede ser mayor que el flujo), y la cola
+  crece duplicándose si llega a llenarse.
+
+  \code
+  SlidingMax window(3);
+  for (int k = 0; k < n; k++)
+      maximum[k] = window.Push(sample[k]);      // max(sample[k-2], sample[k-1], sample[k])
+  \endcode
+
+**/
+class SlidingMax{
+private:
+
+    MaxQueue queue;             ///< Valores de la ventana
+    int window;                 ///< Tamaño de la ventana
+
+public:
+
+    /**
+      * @brief Constructor.
+      * @param window_size Tamaño de la ventana.
+      * @pre window_size >= 1
+      */
+    explicit SlidingMax(int window_size);
+
+    /**
+      * @brief Añade un valor a la ventana, sacando el más antiguo si ya estaba llena.
+      * @param value Valor a añadir.
+      * @return El máximo de la ventana.
+      */
+    int Push(int value){
+        queue.push(value);
+        if (queue.size() > window)
+            queue.pop();
+        return queue.front().max;
+    }
+};
+
+/**
+  * @brief Máximo de ventana deslizante de un flujo de enteros.
+  *
+  * Lee los enteros de in (ver IntReader) y, por cada uno, escribe en out una línea
+  * con el máximo de los window últimos, incluido él (en las primeras window-1
+  * posiciones, el de todos los leídos).
+  *
+  * @param in Fichero abierto para lectura.
+  * @param out Fichero abierto para escritura.
+  * @param window Tamaño de la ventana.
+  * @param count Número de valores procesados. Si el resultado es STREAM_BAD_VALUE, es
+  * también la posición (desde 0) del valor no válido.
+  * @pre window >= 1
+  * @return STREAM_OK si se ha procesado todo el flujo.
+  */
+StreamResult SlidingMaxStream(FILE * in, FILE * out, int window, long & count);
+
+#endif // _SLIDING_MAX_H_
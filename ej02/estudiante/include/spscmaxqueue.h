@@ -0,0 +1,203 @@
+/**
+ * @file spscmaxqueue.h
+ * @brief  Archivo de especificación del TDA SpscMaxQueue
+ * @author Pablo García Bas
+ * @author Andrés Gutiérrez Armenteros
+ */
+
+#ifndef _SPSC_MAX_QUEUE_H_
+#define _SPSC_MAX_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include "ringbuffer.h"
+#include "slidingaggregate.h"
+
+/**
+  @brief T.D.A. SpscMaxQueue
+
+  Una instancia del tipo de dato abstracto SpscMaxQueue es una cola FIFO con máximo de
+  capacidad fija que pueden usar a la vez, sin cerrojos, dos hilos: un productor, que
+  sólo llama a try_push() y push(), y un consumidor, que llama a las demás operaciones.
+
+  front() devuelve el valor del frente y el máximo de todos los valores insertados
+  hasta ese momento que no se hayan sacado. Las operaciones del productor tienen coste
+  O(1); las del consumidor, O(1) amortizado por valor insertado. Ninguna espera al otro
+  hilo (salvo push() cuando la cola está llena) ni reserva memoria.
+
+  \code
+  SpscMaxQueue<int> queue(1024);
+  std::thread sampler([&]{ for (;;) queue.push(Sample()); });
+  for (;;){
+      while (queue.empty())
+          std::this_thread::yield();
+      AggregateElement<int> e = queue.front();      // e.value, e.aggregate (máximo)
+      queue.pop();
+  }
+  \endcode
+
+  \#include <spscmaxqueue.h>
+
+  @author Andrés Gutiérrez
+  @author Pablo García
+
+**/
+template <typename T, typename Element = AggregateElement<T> >
+class SpscMaxQueue{
+    /**
+     @page page_repSpscMaxQueue Representación de SpscMaxQueue
+
+     @section sec_Spsc_Max_Queue SpscMaxQueue
+
+     Los valores están en un buffer circular de tamaño potencia de dos. head y tail cuentan los valores sacados e insertados desde el principio (sin dar la vuelta); la posición de un valor en el buffer es su número de orden & mask. Sólo el productor escribe tail y sólo el consumidor escribe head: el productor escribe el valor y después publica tail con _release_, y el consumidor lee tail con _acquire_ antes de leer los valores nuevos (y al revés con head para reutilizar las posiciones libres).
+
+     El máximo se lleva en el lado del consumidor, que es el único que lo consulta. seen es el número de valores que el consumidor ya ha incorporado y candidates una lista monótona de (posición, valor) de los valores de [head, seen) que pueden llegar a ser máximo: cada uno es estrictamente mayor que todos los que tiene detrás. Al incorporar un valor se quitan del final los candidatos que no son mayores que él, y al sacar el frente se quita el primer candidato si es él. El máximo es el valor del primer candidato. El productor no toca esta lista, así que no hace falta sincronizarla.
+
+     head, con la copia de tail del consumidor, y tail, con la copia de head del productor, van en líneas de caché distintas para que cada hilo sólo escriba en la suya.
+
+   **/
+private:
+
+    static const size_t CACHE_LINE = 64;
+
+    /// Valor de la lista monótona del consumidor
+    struct Candidate{
+        size_t position;    ///< Número de orden del valor
+        T value;            ///< Valor
+    };
+
+    // Compartido, sólo lectura después del constructor
+    std::vector<T> buf;                     ///< Valores; buf[k & mask] es el k-ésimo insertado
+    size_t mask;                            ///< Capacidad - 1
+    char pad0[CACHE_LINE];
+
+    // Lado del productor
+    std::atomic<size_t> tail;               ///< Valores insertados
+    size_t head_cache;                      ///< Última lectura de head por el productor
+    char pad1[CACHE_LINE];
+
+    // Lado del consumidor
+    std::atomic<size_t> head;               ///< Valores sacados
+    size_t seen;                            ///< Valores incorporados a candidates
+    RingBuffer<Candidate> candidates;       ///< Lista monótona de candidatos a máximo
+    char pad2[CACHE_LINE];
+
+    /**
+      * @brief Incorpora a candidates los valores publicados por el productor.
+      * @return Número de valores publicados (tail).
+      */
+    size_t refresh(){
+        size_t t = tail.load(std::memory_order_acquire);
+        for (; seen < t; seen++){
+            const T & v = buf[seen & mask];
+            while (!candidates.empty() && !(v < candidates.back().value))
+                candidates.pop_back();
+            Candidate c = {seen, v};
+            candidates.push_back(c);
+        }
+        return t;
+    }
+
+public:
+
+    /**
+      * @brief Constructor.
+      * @param capacity Número de valores que caben. Se redondea a una potencia de dos.
+      * @pre capacity >= 1
+      */
+    explicit SpscMaxQueue(size_t capacity) : tail(0), head_cache(0), head(0), seen(0){
+        size_t n = 1;
+        while (n < capacity)
+            n *= 2;
+        buf.resize(n);
+        mask = n - 1;
+        candidates.reserve(n);
+    }
+
+    SpscMaxQueue(const SpscMaxQueue &) = delete;
+    SpscMaxQueue & operator=(const SpscMaxQueue &) = delete;
+
+    /**
+      * @brief Número de valores que caben.
+      */
+    size_t capacity() const { return mask + 1; }
+
+    //******************
+    // Productor
+    //******************
+
+    /**
+      * @brief Inserta un valor al final de la cola, si cabe. Sólo la llama el productor.
+      * @param value Valor a insertar.
+      * @return false si la cola estaba llena (y no se inserta). Coste O(1).
+      */
+    bool try_push(const T & value){
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head_cache > mask){
+            head_cache = head.load(std::memory_order_acquire);
+            if (t - head_cache > mask)
+                return false;
+        }
+        buf[t & mask] = value;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+      * @brief Inserta un valor al final de la cola, esperando a que haya sitio. Sólo la llama el productor.
+      * @param value Valor a insertar.
+      */
+    void push(const T & value){
+        while (!try_push(value))
+            std::this_thread::yield();
+    }
+
+    //******************
+    // Consumidor
+    //******************
+
+    /**
+      * @brief Comprueba si la cola está vacía. Sólo la llama el consumidor.
+      * @return true si no hay valores publicados sin sacar.
+      */
+    bool empty(){
+        size_t h = head.load(std::memory_order_relaxed);
+        return seen == h && refresh() == h;
+    }
+
+    /**
+      * @brief Número de valores en la cola. Sólo la llama el consumidor.
+      */
+    size_t size(){
+        return refresh() - head.load(std::memory_order_relaxed);
+    }
+
+    /**
+      * @brief Accede al valor del frente. Sólo la llama el consumidor.
+      * @pre La cola no está vacía.
+      * @return El valor del frente y el máximo de los valores de la cola.
+      */
+    Element front(){
+        refresh();
+        size_t h = head.load(std::memory_order_relaxed);
+        return Element{buf[h & mask], candidates.front().value};
+    }
+
+    /**
+      * @brief Saca el valor del frente. Sólo la llama el consumidor.
+      * @pre La cola no está vacía.
+      */
+    void pop(){
+        size_t h = head.load(std::memory_order_relaxed);
+        if (seen == h)
+            refresh();
+        if (candidates.front().position == h)
+            candidates.pop_front();
+        head.store(h + 1, std::memory_order_release);
+    }
+};
+
+#endif // _SPSC_MAX_QUEUE_H_
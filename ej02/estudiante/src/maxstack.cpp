@@ -6,36 +6,8 @@
 
 #include "maxstack.h"
 
-
-void MaxStack::push(int val ) {
-    queue<element> cola_els;
-    element e;
-    e.maximum = val;
-    e.value = val;
-
-    if(size() != 0) {
-        if (top().maximum >= e.maximum)
-            e.maximum = top().maximum;
-    }
-
-    cola_els.push(e);
-
-    while(!empty()){
-        cola_els.push(top());
-        pop();
-    }
-
-    while(!cola_els.empty()){
-        q.push(cola_els.front());
-        cola_els.pop();
-    }
-}
-
-void MaxStack::pop(){
-    if ( !q.empty()){
-        q.pop() ;
-    }
-}
+// MaxStack se define entera en compactaggregate.h; se instancia aquí para la biblioteca maxstack
+template class CompactAggregateStack<int, MaxOf<int>, element>;
 
 std::ostream & operator<<(std::ostream& os, const element& elem){ // Operador de salida sobrecargado (struct element)
 
@@ -43,4 +15,4 @@ std::ostream & operator<<(std::ostream& os, const element& elem){ // Operador de
 
     return os;
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,182 @@
+/**
+ * @file maxstack_bench.cpp
+ * @brief Fichero que mide ConcurrentMaxStack frente a MaxStack con un mutex con varios hilos a la vez.
+ *
+ * Cada hilo hace operaciones al azar (50% push, 30% pop y 20% consulta del tope)
+ * sobre la misma pila. Con ConcurrentMaxStack se comprueba además que no se pierde
+ * ni se duplica ningún valor y que el máximo de cada nodo es correcto. Termina con
+ * código 1 si encuentra algún error.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "maxstack.h"
+#include "concurrentmaxstack.h"
+
+using namespace std;
+
+// Suma de los máximos consultados, para que el compilador no elimine las consultas
+static atomic<long long> sink_total(0);
+
+// Resultado de las operaciones de un hilo
+struct ThreadTotals{
+    long long pushed_sum, popped_sum;
+    long pushed, popped;
+    long errors;
+};
+
+// Generador pseudoaleatorio de cada hilo
+static unsigned Next(unsigned long long & state){
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (unsigned)(state >> 33);
+}
+
+// Segundos desde t0
+static double Seconds(chrono::steady_clock::time_point t0){
+    return chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+}
+
+// Operaciones por segundo de threads hilos sobre una ConcurrentMaxStack. Suma los errores a errors.
+static double ConcurrentRate(int threads, long ops, long & errors){
+    ConcurrentMaxStack<int> stack;
+    vector<ThreadTotals> totals(threads, ThreadTotals{0, 0, 0, 0, 0});
+
+    chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+    vector<thread> workers;
+    for (int w = 0; w < threads; w++)
+        workers.push_back(thread([&, w]{
+            ConcurrentMaxStack<int>::Handle h(stack);
+            ThreadTotals & t = totals[w];
+            unsigned long long state = w + 1;
+            long long sink = 0;
+            AggregateElement<int> e;
+            for (long k = 0; k < ops; k++){
+                unsigned r = Next(state);
+                if (r % 10 < 5){
+                    int v = r % 1000000;
+                    h.push(v);
+                    t.pushed++;
+                    t.pushed_sum += v;
+                }
+                else if (r % 10 < 8){
+                    if (h.pop(e)){
+                        t.popped++;
+                        t.popped_sum += e.value;
+                        if (e.aggregate < e.value)
+                            t.errors++;
+                    }
+                }
+                else if (h.top(e))
+                    sink += e.aggregate;
+            }
+            sink_total += sink;
+        }));
+    for (size_t w = 0; w < workers.size(); w++)
+        workers[w].join();
+    double s = Seconds(t0);
+
+    // Vaciar la pila comprobando el máximo de cada nodo: al sacar de arriba abajo, el
+    // máximo de un nodo es el mayor entre su valor y el máximo del siguiente
+    ConcurrentMaxStack<int>::Handle h(stack);
+    vector<AggregateElement<int> > rest;
+    AggregateElement<int> e;
+    while (h.pop(e))
+        rest.push_back(e);
+    for (size_t i = 0; i < rest.size(); i++){
+        int below = i + 1 < rest.size() ? rest[i+1].aggregate : rest[i].value;
+        if (rest[i].aggregate != max(rest[i].value, below))
+            errors++;
+    }
+
+    long long pushed_sum = 0, popped_sum = 0;
+    long pushed = 0, popped = rest.size();
+    for (size_t i = 0; i < rest.size(); i++)
+        popped_sum += rest[i].value;
+    for (int w = 0; w < threads; w++){
+        pushed_sum += totals[w].pushed_sum;
+        popped_sum += totals[w].popped_sum;
+        pushed += totals[w].pushed;
+        popped += totals[w].popped;
+        errors += totals[w].errors;
+    }
+    if (pushed != popped || pushed_sum != popped_sum)
+        errors++;
+
+    return threads * ops / s;
+}
+
+// Operaciones por segundo de threads hilos sobre una MaxStack protegida con un mutex
+static double MutexRate(int threads, long ops){
+    MaxStack stack;
+    mutex m;
+
+    chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+    vector<thread> workers;
+    for (int w = 0; w < threads; w++)
+        workers.push_back(thread([&, w]{
+            unsigned long long state = w + 1;
+            long long sink = 0;
+            for (long k = 0; k < ops; k++){
+                unsigned r = Next(state);
+                lock_guard<mutex> lock(m);
+                if (r % 10 < 5)
+                    stack.push(r % 1000000);
+                else if (r % 10 < 8)
+                    stack.pop();
+                else if (!stack.empty())
+                    sink += stack.top().maximum;
+            }
+            sink_total += sink;
+        }));
+    for (size_t w = 0; w < workers.size(); w++)
+        workers[w].join();
+
+    return threads * ops / Seconds(t0);
+}
+
+int main(int argc, char *argv[]){
+
+    int max_threads = max(4u, thread::hardware_concurrency());
+    long ops = 1000000;
+
+    // Comprobar validez de la llamada
+    if (argc > 3){
+        cerr << "Error: Numero incorrecto de parametros.\n";
+        cerr << "Uso: maxstack_bench [<hilos> [<operaciones por hilo>]]\n";
+        exit (1);
+    }
+    if (argc > 1)
+        max_threads = atoi(argv[1]);
+    if (argc > 2)
+        ops = atol(argv[2]);
+    if (max_threads < 1 || ops < 1){
+        cerr << "Error: El numero de hilos y de operaciones deben ser positivos.\n";
+        exit (1);
+    }
+
+    cout << "Operaciones por hilo: " << ops << endl;
+    cout << "Hilos hardware: " << thread::hardware_concurrency() << endl;
+    cout << endl;
+    cout << setw(6) << "hilos" << setw(22) << "ConcurrentMaxStack" << setw(22) << "MaxStack + mutex" << "  (Mops/s)" << endl;
+
+    long errors = 0;
+    cout << fixed << setprecision(2);
+    // Potencias de dos hasta max_threads, y max_threads
+    for (int threads = 1; ; threads = min(2 * threads, max_threads)){
+        double concurrent = ConcurrentRate(threads, ops, errors);
+        double locked = MutexRate(threads, ops);
+        cout << setw(6) << threads << setw(22) << concurrent / 1e6 << setw(22) << locked / 1e6 << endl;
+        if (threads == max_threads)
+            break;
+    }
+
+    cout << endl << "Comprobacion: " << errors << " errores" << endl;
+    return errors == 0 ? 0 : 1;
+}
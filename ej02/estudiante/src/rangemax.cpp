@@ -0,0 +1,122 @@
+/**
+ * @file rangemax.cpp
+ * @brief  Archivo de implementación del TDA RangeMax y del máximo de ventana fija sobre vectores
+ * @author Pablo García Bas
+ * @author Andrés Gutiérrez Armenteros
+ */
+
+#include <algorithm>
+#include <cassert>
+
+#include <rangemax.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+// Mayor k con 2^k <= x
+static inline int Log2(unsigned x){
+#ifdef __GNUC__
+    return 31 - __builtin_clz(x);
+#else
+    int k = 0;
+    while (x >>= 1)
+        k++;
+    return k;
+#endif
+}
+
+// out[i] = max(a[i], b[i]) para i de 0 a n-1. out puede coincidir con a o con b.
+static void MaxOfArrays(const int * a, const int * b, int * out, int n){
+    int i = 0;
+#ifdef __SSE2__
+    // SSE2 no tiene máximo de enteros de 32 bits: se elige con la máscara de la comparación
+    for (; i + 4 <= n; i += 4){
+        __m128i x = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i y = _mm_loadu_si128((const __m128i *)(b + i));
+        __m128i greater = _mm_cmpgt_epi32(x, y);
+        __m128i m = _mm_or_si128(_mm_and_si128(greater, x), _mm_andnot_si128(greater, y));
+        _mm_storeu_si128((__m128i *)(out + i), m);
+    }
+#endif
+    for (; i < n; i++)
+        out[i] = max(a[i], b[i]);
+}
+
+/********************************
+       RANGEMAX
+********************************/
+
+RangeMax::RangeMax() : n(0){
+}
+
+RangeMax::RangeMax(const int * data, int size) : RangeMax(){
+    Build(data, size);
+}
+
+// _____________________________________________________________________________
+
+void RangeMax::Build(const int * data, int size){
+    assert(size >= 0);
+    n = size;
+    table.clear();
+    if (n == 0)
+        return;
+
+    int levels = Log2(n) + 1;
+    table.resize((size_t)levels * n);
+    copy(data, data + n, table.begin());
+    for (int k = 1; k < levels; k++){
+        const int * prev = table.data() + (size_t)(k - 1) * n;
+        int * level = table.data() + (size_t)k * n;
+        int half = 1 << (k - 1);
+        MaxOfArrays(prev, prev + half, level, n - (1 << k) + 1);
+    }
+}
+
+// _____________________________________________________________________________
+
+int RangeMax::Max(int first, int last) const {
+    assert(0 <= first && first < last && last <= n);
+    int k = Log2(last - first);
+    const int * level = table.data() + (size_t)k * n;
+    return max(level[first], level[last - (1 << k)]);
+}
+
+// _____________________________________________________________________________
+
+AggregateElement<int> RangeMax::Query(int first, int last) const {
+    return AggregateElement<int>{table[first], Max(first, last)};
+}
+
+/********************************
+       VENTANA FIJA
+********************************/
+
+void WindowMax(const int * data, int size, int window, int * out){
+    assert(1 <= window && window <= size);
+
+    // prefix[i]: máximo desde el principio del bloque de i hasta i
+    // suffix[i]: máximo desde i hasta el final del bloque de i
+    vector<int> prefix(size), suffix(size);
+    for (int start = 0; start < size; start += window){
+        int end = min(start + window, size);
+        int m = data[start];
+        prefix[start] = m;
+        for (int i = start + 1; i < end; i++){
+            m = max(m, data[i]);
+            prefix[i] = m;
+        }
+        m = data[end - 1];
+        suffix[end - 1] = m;
+        for (int i = end - 2; i >= start; i--){
+            m = max(m, data[i]);
+            suffix[i] = m;
+        }
+    }
+
+    // La ventana [i, i+window) va del resto del bloque de i al principio del siguiente
+    MaxOfArrays(suffix.data(), prefix.data() + window - 1, out, size - window + 1);
+}
@@ -0,0 +1,138 @@
+/**
+ * @file rangemax_bench.cpp
+ * @brief Fichero que compara el máximo de ventana fija con MaxQueue, con RangeMax y con WindowMax.
+ *
+ * Calcula el máximo de todas las ventanas de un vector pseudoaleatorio de tres
+ * formas y comprueba que coinciden, comprueba una muestra de consultas de RangeMax
+ * sobre intervalos al azar recorriéndolos, y mide cada una. Termina con código 1 si
+ * encuentra algún error.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <chrono>
+#include <vector>
+
+#include "maxqueue.h"
+#include "rangemax.h"
+
+using namespace std;
+
+// Número de consultas al azar de RangeMax que se comprueban recorriendo el intervalo
+static const int CHECKED_QUERIES = 1000;
+
+// Suma de los máximos consultados, para que el compilador no elimine las consultas
+static volatile long long sink_total = 0;
+
+// Generador pseudoaleatorio
+static unsigned Next(unsigned long long & state){
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (unsigned)(state >> 33);
+}
+
+// Segundos desde t0
+static double Seconds(chrono::steady_clock::time_point t0){
+    return chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+}
+
+// Número de posiciones en las que difieren a y b
+static long Differences(const vector<int> & a, const vector<int> & b){
+    long errors = 0;
+    for (size_t i = 0; i < a.size(); i++)
+        if (a[i] != b[i])
+            errors++;
+    return errors;
+}
+
+int main(int argc, char *argv[]){
+
+    int n = 1000000, window = 1000;
+
+    // Comprobar validez de la llamada
+    if (argc > 3){
+        cerr << "Error: Numero incorrecto de parametros.\n";
+        cerr << "Uso: rangemax_bench [<valores> [<ventana>]]\n";
+        exit (1);
+    }
+    if (argc > 1)
+        n = atoi(argv[1]);
+    if (argc > 2)
+        window = atoi(argv[2]);
+    if (n < 1 || window < 1 || window > n){
+        cerr << "Error: La ventana debe estar entre 1 y el numero de valores.\n";
+        exit (1);
+    }
+
+    vector<int> data(n);
+    unsigned long long state = 1;
+    for (int i = 0; i < n; i++)
+        data[i] = Next(state) % 1000000;
+
+    int windows = n - window + 1;
+    vector<int> by_queue(windows), by_index(windows), by_blocks(windows);
+    chrono::steady_clock::time_point t0;
+
+    // MaxQueue: cada valor entra en la cola y sale window valores después
+    t0 = chrono::steady_clock::now();
+    MaxQueue queue;
+    queue.reserve((size_t)window + 1);
+    for (int i = 0; i < n; i++){
+        queue.push(data[i]);
+        if (queue.size() > window)
+            queue.pop();
+        if (i >= window - 1)
+            by_queue[i - window + 1] = queue.front().max;
+    }
+    double queue_s = Seconds(t0);
+
+    // RangeMax: construir el índice y consultar cada ventana
+    t0 = chrono::steady_clock::now();
+    RangeMax index(data.data(), n);
+    double build_s = Seconds(t0);
+    t0 = chrono::steady_clock::now();
+    for (int i = 0; i < windows; i++)
+        by_index[i] = index.Max(i, i + window);
+    double index_s = Seconds(t0);
+
+    // WindowMax: van Herk / Gil-Werman
+    t0 = chrono::steady_clock::now();
+    WindowMax(data.data(), n, window, by_blocks.data());
+    double blocks_s = Seconds(t0);
+
+    long errors = Differences(by_queue, by_index) + Differences(by_queue, by_blocks);
+
+    // Consultas de intervalos al azar
+    vector<int> first(windows), last(windows);
+    for (int i = 0; i < windows; i++){
+        first[i] = Next(state) % n;
+        last[i] = first[i] + 1 + Next(state) % (n - first[i]);
+    }
+    t0 = chrono::steady_clock::now();
+    long long sink = 0;
+    for (int i = 0; i < windows; i++)
+        sink += index.Max(first[i], last[i]);
+    double random_s = Seconds(t0);
+    sink_total += sink;
+
+    for (int i = 0; i < CHECKED_QUERIES && i < windows; i++){
+        AggregateElement<int> e = index.Query(first[i], last[i]);
+        int maximum = data[first[i]];
+        for (int j = first[i]; j < last[i]; j++)
+            maximum = max(maximum, data[j]);
+        if (e.value != data[first[i]] || e.aggregate != maximum)
+            errors++;
+    }
+
+    cout << "Valores: " << n << ", ventana: " << window << endl;
+    cout << endl;
+    cout << fixed << setprecision(2);
+    cout << setw(38) << left << "MaxQueue" << right << setw(10) << queue_s * 1e9 / n << " ns/valor" << endl;
+    cout << setw(38) << left << "RangeMax (construccion)" << right << setw(10) << build_s * 1e9 / n << " ns/valor" << endl;
+    cout << setw(38) << left << "RangeMax (una consulta por ventana)" << right << setw(10) << index_s * 1e9 / windows << " ns/consulta" << endl;
+    cout << setw(38) << left << "RangeMax (intervalos al azar)" << right << setw(10) << random_s * 1e9 / windows << " ns/consulta" << endl;
+    cout << setw(38) << left << "WindowMax" << right << setw(10) << blocks_s * 1e9 / n << " ns/valor" << endl;
+
+    cout << endl << "Comprobacion: " << errors << " errores" << endl;
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,56 @@
+/**
+ * @file sliding_max.cpp
+ * @brief Fichero que calcula el máximo de ventana deslizante de un flujo de enteros con MaxQueue.
+ *
+ * Lee los enteros de un fichero (o de la entrada estándar) y escribe, por cada uno,
+ * el máximo de la ventana que termina en él.
+ */
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+
+#include "slidingmax.h"
+
+using namespace std;
+
+int main(int argc, char *argv[]){
+
+    // Comprobar validez de la llamada
+    if (argc != 2 && argc != 3){
+        cerr << "Error: Numero incorrecto de parametros.\n";
+        cerr << "Uso: sliding_max <ventana> [<FichEntrada>]\n";
+        exit (1);
+    }
+
+    int window = atoi(argv[1]);
+    if (window < 1){
+        cerr << "Error: La ventana debe tener al menos un elemento.\n";
+        exit (1);
+    }
+
+    FILE * in = stdin;
+    if (argc == 3){
+        in = fopen(argv[2], "rb");
+        if (!in){
+            cerr << "Error: No pudo abrirse " << argv[2] << ".\n";
+            exit (1);
+        }
+    }
+
+    long count;
+    StreamResult result = SlidingMaxStream(in, stdout, window, count);
+    if (in != stdin)
+        fclose(in);
+
+    if (result == STREAM_BAD_VALUE){
+        cerr << "Error: El valor " << count + 1 << " no es un entero valido.\n";
+        return 1;
+    }
+    if (result == STREAM_WRITE_ERROR){
+        cerr << "Error: No pudo escribirse el resultado.\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,140 @@
+/**
+ * @file slidingmax.cpp
+ * @brief  Archivo de implementación del máximo de ventana deslizante sobre flujos de enteros
+ * @author Pablo García Bas
+ * @author Andrés Gutiérrez Armenteros
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <climits>
+
+#include <slidingmax.h>
+
+// Elementos que SlidingMax reserva como mucho al construirse (512 KB con int)
+static const size_t SLIDING_MAX_RESERVE = 1 << 16;
+
+static bool IsSpace(char c){
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+/********************************
+      LECTOR
+********************************/
+
+IntReader::IntReader(FILE * file) : in(file), pos(buffer), end(buffer), bad(false){
+}
+
+// _____________________________________________________________________________
+
+bool IntReader::Refill(){
+    size_t n = fread(buffer, 1, BUFFER_SIZE, in);
+    pos = buffer;
+    end = buffer + n;
+    return n > 0;
+}
+
+// _____________________________________________________________________________
+
+bool IntReader::Next(int & value){
+    // Saltar los separadores
+    for (;;){
+        while (pos < end && IsSpace(*pos))
+            pos++;
+        if (pos < end)
+            break;
+        if (!Refill())
+            return false;
+    }
+
+    // Leer el valor, que puede seguir en el bloque siguiente. Se acumula en negativo
+    // para que quepa INT_MIN.
+    bool negative = false, digits = false;
+    long long acc = 0;
+    if (*pos == '-' || *pos == '+'){
+        negative = *pos == '-';
+        pos++;
+    }
+    for (;;){
+        while (pos < end && *pos >= '0' && *pos <= '9'){
+            acc = acc * 10 - (*pos - '0');
+            digits = true;
+            if (acc < INT_MIN){
+                bad = true;
+                return false;
+            }
+            pos++;
+        }
+        if (pos < end || !Refill())
+            break;
+    }
+
+    if (!digits || (pos < end && !IsSpace(*pos)) || (!negative && acc == INT_MIN)){
+        bad = true;
+        return false;
+    }
+    value = negative ? (int)acc : (int)-acc;
+    return true;
+}
+
+/********************************
+      ESCRITOR
+********************************/
+
+void IntWriter::Put(int value){
+    // Un int ocupa como mucho 11 caracteres más el salto de línea
+    if (used > BUFFER_SIZE - 12)
+        Flush();
+
+    char digits[12];
+    int n = 0;
+    unsigned u = value < 0 ? 0u - (unsigned)value : (unsigned)value;
+    do{
+        digits[n++] = '0' + u % 10;
+        u /= 10;
+    } while (u != 0);
+
+    if (value < 0)
+        buffer[used++] = '-';
+    while (n > 0)
+        buffer[used++] = digits[--n];
+    buffer[used++] = '\n';
+}
+
+// _____________________________________________________________________________
+
+bool IntWriter::Flush(){
+    if (used > 0 && fwrite(buffer, 1, used, out) != (size_t)used)
+        bad = true;
+    used = 0;
+    return !bad;
+}
+
+/********************************
+      VENTANA DESLIZANTE
+********************************/
+
+SlidingMax::SlidingMax(int window_size) : window(window_size){
+    assert(window_size >= 1);
+    // Una ventana mayor que el flujo es válida: más allá del límite la cola crece al llenarse
+    queue.reserve(std::min((size_t)window_size + 1, SLIDING_MAX_RESERVE));
+}
+
+// _____________________________________________________________________________
+
+StreamResult SlidingMaxStream(FILE * in, FILE * out, int window, long & count){
+    IntReader reader(in);
+    IntWriter writer(out);
+    SlidingMax sliding(window);
+
+    count = 0;
+    int value;
+    while (reader.Next(value)){
+        writer.Put(sliding.Push(value));
+        count++;
+    }
+
+    if (!writer.Flush() || fflush(out) != 0)
+        return STREAM_WRITE_ERROR;
+    return reader.error() ? STREAM_BAD_VALUE : STREAM_OK;
+}
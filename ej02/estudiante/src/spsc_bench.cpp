@@ -0,0 +1,169 @@
+/**
+ * @file spsc_bench.cpp
+ * @brief Fichero que comprueba SpscMaxQueue entre dos hilos y mide su rendimiento frente a MaxQueue con un mutex.
+ *
+ * Un hilo productor inserta una secuencia pseudoaleatoria conocida y el consumidor
+ * comprueba cada frente y, cada cierto número de valores, que el máximo es el de
+ * los valores de la cola en algún momento de la llamada. Termina con código 1 si
+ * encuentra algún error.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#include "maxqueue.h"
+#include "spscmaxqueue.h"
+
+using namespace std;
+
+// Cada cuántos valores se comprueba el máximo (recorriendo la cola)
+static const long CHECK_EVERY = 97;
+
+// Suma de los máximos consultados, para que el compilador no elimine las consultas
+static volatile long long sink_total = 0;
+
+// Valor k-ésimo de la secuencia
+static int Value(long k){
+    unsigned long long z = (unsigned long long)k * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return (int)((z ^ (z >> 31)) % 1000000);
+}
+
+// Segundos desde t0
+static double Seconds(chrono::steady_clock::time_point t0){
+    return chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+}
+
+// Pasa n valores por una SpscMaxQueue comprobando los resultados. Devuelve el número de errores.
+static long Check(long n, size_t capacity){
+    SpscMaxQueue<int> queue(capacity);
+    thread producer([&]{
+        for (long k = 0; k < n; k++)
+            queue.push(Value(k));
+    });
+
+    long errors = 0;
+    for (long k = 0; k < n; k++){
+        while (queue.empty())
+            this_thread::yield();
+
+        if (k % CHECK_EVERY == 0){
+            // El máximo tiene que ser el de [k, k+t) para algún t entre los dos tamaños
+            size_t before = queue.size();
+            AggregateElement<int> e = queue.front();
+            size_t after = queue.size();
+            int maximum = Value(k);
+            bool found = false;
+            for (size_t t = 1; t <= after && !found; t++){
+                if (t > 1)
+                    maximum = max(maximum, Value(k + t - 1));
+                found = t >= before && maximum == e.aggregate;
+            }
+            if (e.value != Value(k) || !found)
+                errors++;
+        }
+        else if (queue.front().value != Value(k))
+            errors++;
+
+        queue.pop();
+    }
+    producer.join();
+    return errors;
+}
+
+// Valores por segundo a través de una SpscMaxQueue
+static double SpscRate(long n, size_t capacity){
+    SpscMaxQueue<int> queue(capacity);
+    long long sink = 0;
+    chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+    thread producer([&]{
+        for (long k = 0; k < n; k++)
+            queue.push(Value(k));
+    });
+    for (long k = 0; k < n; k++){
+        while (queue.empty())
+            this_thread::yield();
+        sink += queue.front().aggregate;
+        queue.pop();
+    }
+    producer.join();
+    double s = Seconds(t0);
+    sink_total += sink;
+    return n / s;
+}
+
+// Valores por segundo a través de una MaxQueue protegida con un mutex
+static double MutexRate(long n, size_t capacity){
+    MaxQueue queue;
+    mutex m;
+    long long sink = 0;
+    chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+    thread producer([&]{
+        for (long k = 0; k < n; ){
+            {
+                lock_guard<mutex> lock(m);
+                if ((size_t)queue.size() < capacity){
+                    queue.push(Value(k));
+                    k++;
+                    continue;
+                }
+            }
+            this_thread::yield();
+        }
+    });
+    for (long k = 0; k < n; ){
+        {
+            lock_guard<mutex> lock(m);
+            if (!queue.empty()){
+                sink += queue.front().max;
+                queue.pop();
+                k++;
+                continue;
+            }
+        }
+        this_thread::yield();
+    }
+    producer.join();
+    double s = Seconds(t0);
+    sink_total += sink;
+    return n / s;
+}
+
+int main(int argc, char *argv[]){
+
+    long n = 10000000;
+    long capacity = 1024;
+
+    // Comprobar validez de la llamada
+    if (argc > 3){
+        cerr << "Error: Numero incorrecto de parametros.\n";
+        cerr << "Uso: spsc_bench [<valores> [<capacidad>]]\n";
+        exit (1);
+    }
+    if (argc > 1)
+        n = atol(argv[1]);
+    if (argc > 2)
+        capacity = atol(argv[2]);
+    if (n < 1 || capacity < 1){
+        cerr << "Error: El numero de valores y la capacidad deben ser positivos.\n";
+        exit (1);
+    }
+
+    cout << "Valores: " << n << endl;
+    cout << "Capacidad: " << capacity << endl;
+    cout << "Hilos hardware: " << thread::hardware_concurrency() << endl;
+
+    long errors = Check(n, capacity);
+    cout << "Comprobacion: " << errors << " errores" << endl;
+
+    cout << fixed << setprecision(1);
+    cout << "SpscMaxQueue:      " << setw(8) << SpscRate(n, capacity) / 1e6 << " Mvalores/s" << endl;
+    cout << "MaxQueue + mutex:  " << setw(8) << MutexRate(n, capacity) / 1e6 << " Mvalores/s" << endl;
+
+    return errors == 0 ? 0 : 1;
+}